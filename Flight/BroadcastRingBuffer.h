@@ -0,0 +1,426 @@
+#ifndef BROADCASTRINGBUFFER_H
+#define BROADCASTRINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include "RingBuffer.h"
+#include "RingStorage.h"
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Single producer, many readers: every reader sees every sample, none is copied per reader
+ *
+ * Disruptor-style: the producer writes each sample once and every reader walks
+ * the same slots with its own cursor. Readers register at runtime (up to
+ * MAX_READERS) and start at the current head.
+ *
+ * The producer keeps a cached copy of the slowest reader's cursor and only
+ * rescans the cursors when that copy says the ring is full, like RingBuffer's
+ * cached indices. What happens then depends on the policy:
+ * - Backpressure: reserve() returns fewer slots, the slowest reader holds the producer back.
+ * - Lossy: the producer overwrites the oldest samples and a lagging reader is lapped.
+ *
+ * In both cases the producer publishes the end of the range it is about to
+ * write (m_claim) before touching a slot, and each reader checks it before and
+ * after reading (the same double check a seqlock reader makes), so a lapped
+ * reader loses samples, counted in its dropped(), but never sees a torn one. That check
+ * also covers a reader registering while the producer runs.
+ *
+ * Optionally each slot has columns: further values stored column by column
+ * beside the slots (structure of arrays), e.g. one column per channel next to a
+ * slot holding the timestamp. columnSpans() maps slot spans to the same range
+ * of a column; columns are written between reserve() and commit() and read
+ * between peek() and consume(), so the slots' claim protocol covers them too.
+ *
+ * A reader can block in wait_for() until a number of samples or a deadline
+ * arrives instead of polling. It arms a target head in its own Reader and its
+ * bit in m_waiting, then sleeps on a futex word of its own. After publishing,
+ * commit() fences and reads m_waiting, one load of a line nobody writes in
+ * steady flow; only when an armed reader's target has been reached does it
+ * enter the kernel, and only for that reader. Other platforms nap in 200 us
+ * slices.
+ *
+ * Template parameters:
+ * - T: Trivially copyable element type
+ * - Column: Trivially copyable column element type
+ */
+template<typename T, typename Column = float>
+class BroadcastRingBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Column>::value, "Column must be trivially copyable");
+
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr int MAX_READERS = 8;
+
+    enum Policy {
+        Backpressure,
+        Lossy
+    };
+
+    typedef RingSpans<T> WriteSpans;
+    typedef RingSpans<const T> ReadSpans;
+
+    BroadcastRingBuffer(size_t capacity, Policy policy, int columns = 0) :
+        m_size(roundUpToPowerOf2(capacity)),
+        m_mask(m_size - 1),
+        m_policy(policy),
+        m_columns(columns),
+        m_storage(m_size),
+        m_buffer(m_storage.data()),
+        m_columnStorage(m_size * static_cast<size_t>(columns))
+    {
+    }
+
+    BroadcastRingBuffer(const BroadcastRingBuffer &) = delete;
+    BroadcastRingBuffer &operator=(const BroadcastRingBuffer &) = delete;
+
+    // The storage could not be allocated: the ring must not be used
+    bool isNull() const noexcept { return m_storage.isNull() || m_columnStorage.isNull(); }
+
+    size_t capacity() const noexcept { return m_size; }
+    Policy policy() const noexcept { return m_policy; }
+    int columns() const noexcept { return m_columns; }
+    const char *backingName() const noexcept {
+        return m_columns > 0 ? m_columnStorage.backingName() : m_storage.backingName();
+    }
+
+    /**
+     * @brief The slots of spans from reserve() in column c (producer thread only)
+     */
+    RingSpans<Column> columnSpans(const WriteSpans &spans, int c) noexcept {
+        return ::columnSpans(spans, m_buffer, m_columnStorage.data() + static_cast<size_t>(c) * m_size);
+    }
+
+    /**
+     * @brief The slots of spans from peek() in column c (that reader's thread only)
+     */
+    RingSpans<const Column> columnSpans(const ReadSpans &spans, int c) const noexcept {
+        return ::columnSpans(spans, static_cast<const T *>(m_buffer),
+                             static_cast<const Column *>(m_columnStorage.data() + static_cast<size_t>(c) * m_size));
+    }
+
+    /**
+     * @brief Register a reader starting at the current head (any thread)
+     * @return Reader id, or -1 if MAX_READERS are registered
+     */
+    int addReader() noexcept {
+        for (int id = 0; id < MAX_READERS; id++) {
+            Reader &reader = m_readers[id];
+            bool expected = false;
+            if (!reader.registered.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                continue;
+            reader.dropped.store(0, std::memory_order_relaxed);
+            reader.cursor.store(m_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+            reader.active.store(true, std::memory_order_release);
+            return id;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Unregister a reader; it no longer holds the producer back (any thread)
+     */
+    void removeReader(int id) noexcept {
+        if (id < 0 || id >= MAX_READERS) return;
+        m_readers[id].active.store(false, std::memory_order_release);
+        m_readers[id].registered.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of samples the reader has not consumed yet (any thread)
+     */
+    size_t size(int id) const noexcept {
+        const uint64_t cursor = m_readers[id].cursor.load(std::memory_order_acquire);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return static_cast<size_t>(std::min<uint64_t>(head - std::min(head, cursor), m_size));
+    }
+
+    double usage(int id) const noexcept {
+        return static_cast<double>(size(id)) / capacity();
+    }
+
+    /**
+     * @brief Backlog of the slowest active reader (any thread)
+     */
+    size_t size() const noexcept {
+        const uint64_t slowest = slowestCursor();
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return static_cast<size_t>(std::min<uint64_t>(head - std::min(head, slowest), m_size));
+    }
+
+    double usage() const noexcept {
+        return static_cast<double>(size()) / capacity();
+    }
+
+    /**
+     * @brief Samples this reader lost to being lapped (any thread)
+     */
+    uint64_t dropped(int id) const noexcept {
+        return m_readers[id].dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cursor of the slowest active reader, or the head if there is none (any thread)
+     */
+    uint64_t slowestCursor() const noexcept {
+        uint64_t slowest = m_head.load(std::memory_order_acquire);
+        for (const Reader &reader : m_readers) {
+            if (reader.active.load(std::memory_order_acquire))
+                slowest = std::min(slowest, reader.cursor.load(std::memory_order_acquire));
+        }
+        return slowest;
+    }
+
+    /**
+     * @brief Claim up to count slots for writing in place (producer thread only)
+     *
+     * Lossy: always min(count, capacity()). Backpressure: no more than the slowest
+     * reader has freed. Publish with commit().
+     */
+    WriteSpans reserve(size_t count) noexcept {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        size_t n = std::min(count, m_size);
+
+        if (m_policy == Backpressure) {
+            if (head + n - m_cachedSlowest > m_size)
+                m_cachedSlowest = slowestCursor();
+            n = static_cast<size_t>(std::min<uint64_t>(n, m_size - (head - m_cachedSlowest)));
+        }
+
+        // Never lowered: slots of an earlier, partly committed claim may already be scribbled on
+        if (head + n > m_claim.load(std::memory_order_relaxed))
+            m_claim.store(head + n, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);  // Claim is visible before any slot changes
+
+        return writeSpansAt(head, n);
+    }
+
+    /**
+     * @brief Publish the first count slots of the last reservation (producer thread only)
+     */
+    void commit(size_t count) noexcept {
+        const uint64_t head = m_head.load(std::memory_order_relaxed) + count;
+        m_head.store(head, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // Pairs with wait_for()'s fence
+        if (m_waiting.load(std::memory_order_relaxed) != 0)
+            wakeReaders(head);
+    }
+
+    /**
+     * @brief Copy a run of elements in, without columns (producer thread only)
+     * @return Number of elements pushed; less than count only under backpressure
+     */
+    size_t push_batch(const T* items, size_t count) noexcept {
+        size_t pushed = 0;
+        while (pushed < count) {
+            const WriteSpans spans = reserve(count - pushed);
+            if (spans.size() == 0)
+                break;
+            std::copy(items + pushed, items + pushed + spans.first_size, spans.first);
+            std::copy(items + pushed + spans.first_size, items + pushed + spans.size(), spans.second);
+            commit(spans.size());
+            pushed += spans.size();
+        }
+        return pushed;
+    }
+
+    /**
+     * @brief Look at up to count unread samples in place (that reader's thread only)
+     *
+     * Samples the producer has already lapped are skipped and counted as dropped.
+     */
+    ReadSpans peek(int id, size_t count = SIZE_MAX) noexcept {
+        Reader &reader = m_readers[id];
+        // Claim before head: a claim loaded later may lap the head loaded earlier
+        uint64_t cursor = reader.cursor.load(std::memory_order_relaxed);
+        const uint64_t oldest = oldestIntact(m_claim.load(std::memory_order_acquire));
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+
+        if (cursor < oldest) {
+            reader.dropped.store(reader.dropped.load(std::memory_order_relaxed) + (oldest - cursor),
+                                 std::memory_order_relaxed);
+            cursor = oldest;
+            reader.cursor.store(cursor, std::memory_order_release);
+        }
+
+        const uint64_t available = std::min<uint64_t>(head - std::min(head, cursor), m_size);
+        return readSpansAt(cursor, static_cast<size_t>(std::min<uint64_t>(count, available)));
+    }
+
+    /**
+     * @brief Move the reader past the first count samples of its last peek() (that reader's thread only)
+     * @return How many of those, from the front, were overwritten while being read;
+     *         the caller must discard them (they are counted as dropped)
+     */
+    size_t consume(int id, size_t count) noexcept {
+        Reader &reader = m_readers[id];
+        std::atomic_thread_fence(std::memory_order_acquire);  // Slot reads complete before the recheck
+        const uint64_t oldest = oldestIntact(m_claim.load(std::memory_order_relaxed));
+        const uint64_t cursor = reader.cursor.load(std::memory_order_relaxed);
+
+        const size_t torn = cursor < oldest ? static_cast<size_t>(std::min<uint64_t>(count, oldest - cursor)) : 0;
+        if (torn > 0)
+            reader.dropped.store(reader.dropped.load(std::memory_order_relaxed) + torn, std::memory_order_relaxed);
+
+        reader.cursor.store(cursor + count, std::memory_order_release);
+        return torn;
+    }
+
+    /**
+     * @brief Block until at least min_count samples are unread or the timeout passes (that reader's thread only)
+     * @return Number of unread samples, less than min_count on timeout
+     */
+    size_t wait_for(int id, size_t min_count, std::chrono::nanoseconds timeout) noexcept {
+        Reader &reader = m_readers[id];
+        const uint32_t bit = 1u << id;
+        min_count = std::max<size_t>(1, std::min(min_count, m_size));
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        for (;;) {
+            size_t available = size(id);
+            if (available >= min_count)
+                return available;
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds::zero())
+                return available;
+
+            // Arm, then look again: either we see the producer's new head or it sees the target
+            const uint32_t wakeups = reader.wakeups.load(std::memory_order_acquire);
+            reader.waitTarget.store(reader.cursor.load(std::memory_order_relaxed) + min_count, std::memory_order_relaxed);
+            m_waiting.fetch_or(bit, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            available = size(id);
+            if (available < min_count)
+                sleepOnWakeups(reader.wakeups, wakeups, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+            m_waiting.fetch_and(~bit, std::memory_order_relaxed);
+            reader.waitTarget.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Copy up to max_count unread samples out (that reader's thread only)
+     * @return Number of intact samples copied to items
+     */
+    size_t pop_batch(int id, T* items, size_t max_count) noexcept {
+        if (!items || max_count == 0) return 0;
+
+        const ReadSpans spans = peek(id, max_count);
+        std::copy(spans.first, spans.first + spans.first_size, items);
+        std::copy(spans.second, spans.second + spans.second_size, items + spans.first_size);
+
+        const size_t torn = consume(id, spans.size());
+        if (torn > 0)
+            std::copy(items + torn, items + spans.size(), items);
+        return spans.size() - torn;
+    }
+
+    /**
+     * @brief Skip everything unread and reset the reader's drop counter (that reader's thread only)
+     */
+    void clear(int id) noexcept {
+        m_readers[id].cursor.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+        m_readers[id].dropped.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // One cache line per reader: cursors are written by different threads
+    struct alignas(CACHE_LINE_SIZE) Reader {
+        std::atomic<uint64_t> cursor{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> active{false};      // Counted by the producer's slowest-reader scan
+        std::atomic<bool> registered{false};  // Id taken
+        std::atomic<uint64_t> waitTarget{0};  // Head wait_for() needs, 0 = not waiting
+        std::atomic<uint32_t> wakeups{0};     // Futex word, bumped on every wake
+    };
+
+    // Producer side, after publishing: wake the armed readers whose target is reached
+    void wakeReaders(uint64_t head) noexcept {
+        uint32_t waiting = m_waiting.load(std::memory_order_relaxed);
+        for (int id = 0; waiting != 0; id++, waiting >>= 1) {
+            if (!(waiting & 1))
+                continue;
+            Reader &reader = m_readers[id];
+            const uint64_t target = reader.waitTarget.load(std::memory_order_relaxed);
+            if (target == 0 || head < target)
+                continue;
+            if (reader.waitTarget.exchange(0, std::memory_order_relaxed) == 0)
+                continue;  // The reader disarmed meanwhile
+            reader.wakeups.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&reader.wakeups), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+        }
+    }
+
+    // Reader side: returns once word moves past seen, on timeout or spuriously
+    static void sleepOnWakeups(std::atomic<uint32_t> &word, uint32_t seen, std::chrono::nanoseconds timeout) noexcept {
+#ifdef __linux__
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+#else
+        // No futex: nap in short slices
+        if (word.load(std::memory_order_acquire) == seen)
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(200)));
+#endif
+    }
+
+    static size_t roundUpToPowerOf2(size_t capacity) noexcept {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+    uint64_t oldestIntact(uint64_t claim) const noexcept {
+        return claim > m_size ? claim - m_size : 0;
+    }
+
+    template<typename Spans>
+    Spans spansAt(uint64_t position, size_t n) const noexcept {
+        Spans spans;
+        const size_t index = static_cast<size_t>(position) & m_mask;
+        spans.first = m_buffer + index;
+        spans.first_size = std::min(n, m_size - index);
+        spans.second = m_buffer;
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    WriteSpans writeSpansAt(uint64_t position, size_t n) noexcept { return spansAt<WriteSpans>(position, n); }
+    ReadSpans readSpansAt(uint64_t position, size_t n) const noexcept { return spansAt<ReadSpans>(position, n); }
+
+    // Read-only after construction, shared by everyone
+    alignas(CACHE_LINE_SIZE) const size_t m_size;
+    const size_t m_mask;
+    const Policy m_policy;
+    const int m_columns;
+    RingStorage<T> m_storage;
+    T *const m_buffer;
+    RingStorage<Column> m_columnStorage;  // Column c of slot i at c * m_size + i
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head{0};  // Written and published by the producer
+    std::atomic<uint64_t> m_claim{0};                            // End of the range the producer is writing
+    uint64_t m_cachedSlowest = 0;                                // Producer's last view of the slowest cursor
+
+    // Written by readers only when they go to sleep, so the producer's check stays a cache hit
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_waiting{0};  // Bit per reader in wait_for()
+
+    Reader m_readers[MAX_READERS];
+};
+
+#endif // BROADCASTRINGBUFFER_H
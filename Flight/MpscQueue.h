@@ -0,0 +1,212 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include "RingBuffer.h"
+
+/**
+ * @brief Bounded lock-free Multi Producer Single Consumer (MPSC) queue
+ *
+ * Several producer threads (e.g. one decoder per link) feed one consumer
+ * without a ring per producer and a merge step.
+ *
+ * Every slot carries a sequence number saying whose turn it is: a slot is free
+ * for the write of position p when its sequence is p, holds the element of
+ * position p when it is p + 1, and becomes free for p + Size once the consumer
+ * stores that. Producers claim a run of positions with one CAS on m_head, fill
+ * the slots and publish each one by bumping its sequence. The consumer owns
+ * m_tail outright: it checks sequences and never needs a CAS.
+ *
+ * Delivery is in claim order, so a producer stalled between claim and commit
+ * blocks the consumer at its first unpublished slot: everything claimed after
+ * it, by any producer, waits behind it (head-of-line blocking), and once the
+ * queue fills the other producers' claims fail too. Producers must not block
+ * between reserve() and commit().
+ *
+ * Same batch API as RingBuffer: push_batch()/reserve()/commit() on the producer
+ * side (each producer its own runs), pop_batch()/peek()/consume() on the consumer.
+ * Elements come out in claim order; runs from different producers never interleave.
+ *
+ * Template parameters:
+ * - T: Type of elements stored in the queue
+ * - Size: Queue capacity (must be power of 2)
+ */
+template<typename T, size_t Size>
+class MpscQueue
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of 2");
+    static_assert(Size > 1, "Size must be greater than 1");
+
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    typedef RingSpans<T> WriteSpans;
+    typedef RingSpans<const T> ReadSpans;
+
+    MpscQueue() {
+        for (size_t i = 0; i < Size; i++)
+            m_sequence[i].store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get current number of claimed elements (any thread, approximate)
+     */
+    size_t size() const noexcept {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return std::min(head - tail, Size);
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * @brief Get queue capacity
+     */
+    static constexpr size_t capacity() noexcept {
+        return Size;
+    }
+
+    /**
+     * @brief Get queue usage as percentage (0.0 to 1.0)
+     */
+    double usage() const noexcept {
+        return static_cast<double>(size()) / capacity();
+    }
+
+    /**
+     * @brief Push element to queue (any producer thread)
+     * @return true if successful, false if queue is full
+     */
+    bool push(const T& item) noexcept {
+        const WriteSpans spans = reserve(1);
+        if (spans.size() == 0) return false;
+        spans.first[0] = item;
+        commit(spans);
+        return true;
+    }
+
+    /**
+     * @brief Copy a run of elements in, contiguous in queue order (any producer thread)
+     * @return Number of elements pushed, less than count if the queue filled up
+     */
+    size_t push_batch(const T* items, size_t count) noexcept {
+        const WriteSpans spans = reserve(count);
+        std::copy(items, items + spans.first_size, spans.first);
+        std::copy(items + spans.first_size, items + spans.size(), spans.second);
+        commit(spans);
+        return spans.size();
+    }
+
+    /**
+     * @brief Claim up to count consecutive free slots for writing in place (any producer thread)
+     * @return Spans covering the claimed slots; hand the same spans to commit()
+     */
+    WriteSpans reserve(size_t count) noexcept {
+        WriteSpans spans;
+        if (count == 0) return spans;
+
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t n;
+        for (;;) {
+            // The consumer frees slots in order and publishes m_tail after their sequences
+            const size_t tail = m_tail.load(std::memory_order_acquire);
+            if (head < tail) {
+                head = m_head.load(std::memory_order_relaxed);
+                continue;  // Our view of m_head is older than the consumer's progress
+            }
+            n = std::min(count, Size - std::min(head - tail, Size));
+            if (n == 0)
+                return spans;  // Queue is full
+            if (m_head.compare_exchange_weak(head, head + n, std::memory_order_relaxed))
+                break;  // On failure head now holds the current claim position
+        }
+
+        const size_t index = head & (Size - 1);
+        spans.first = &m_buffer[index];
+        spans.first_size = std::min(n, Size - index);
+        spans.second = m_buffer.data();
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    /**
+     * @brief Publish slots obtained from reserve() (the same producer thread)
+     */
+    void commit(const WriteSpans& spans) noexcept {
+        if (spans.size() == 0) return;
+        publish(static_cast<size_t>(spans.first - m_buffer.data()), spans.size());
+    }
+
+    /**
+     * @brief Pop element from queue (consumer thread only)
+     * @return true if successful, false if no element is ready
+     */
+    bool pop(T& item) noexcept {
+        return pop_batch(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Pop multiple elements from queue (consumer thread only)
+     * @return Number of elements actually popped
+     */
+    size_t pop_batch(T* items, size_t max_count) noexcept {
+        if (!items || max_count == 0) return 0;
+
+        const ReadSpans spans = peek(max_count);
+        std::copy(spans.first, spans.first + spans.first_size, items);
+        std::copy(spans.second, spans.second + spans.second_size, items + spans.first_size);
+        consume(spans.size());
+        return spans.size();
+    }
+
+    /**
+     * @brief Look at up to count published elements in place (consumer thread only)
+     *
+     * Stops at the first slot whose producer has not committed yet, even if later
+     * ones have. The spans stay valid until the matching consume().
+     */
+    ReadSpans peek(size_t count = Size) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t limit = std::min(count, Size);
+        size_t n = 0;
+        while (n < limit && m_sequence[(tail + n) & (Size - 1)].load(std::memory_order_acquire) == tail + n + 1)
+            n++;
+
+        ReadSpans spans;
+        const size_t index = tail & (Size - 1);
+        spans.first = &m_buffer[index];
+        spans.first_size = std::min(n, Size - index);
+        spans.second = m_buffer.data();
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    /**
+     * @brief Hand the first count elements of the last peek() back to the producers (consumer thread only)
+     */
+    void consume(size_t count) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; i++)
+            m_sequence[(tail + i) & (Size - 1)].store(tail + i + Size, std::memory_order_release);
+        m_tail.store(tail + count, std::memory_order_release);
+    }
+
+private:
+    void publish(size_t index, size_t count) noexcept {
+        for (size_t i = 0; i < count; i++) {
+            std::atomic<size_t>& sequence = m_sequence[(index + i) & (Size - 1)];
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};  // Next position to claim, shared by producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};  // Next position to read, consumer only writes
+
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<size_t>, Size> m_sequence;
+    alignas(CACHE_LINE_SIZE) std::array<T, Size> m_buffer;
+};
+
+#endif // MPSCQUEUE_H
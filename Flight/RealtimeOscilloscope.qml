@@ -13,12 +13,6 @@ Rectangle {
     border.width: 2
     radius: 8
 
-<<<<<<< HEAD
-    // Simple properties
-    property real range: 0.005
-    property real refreshPoints: 0.005
-    property bool isRunning: false
-=======
     // Backend data source
     SineWaveTest {
         id: sineWaveBackend
@@ -34,24 +28,26 @@ Rectangle {
         onBufferUsageChanged: function(usage) {
             oscilloscopeRoot.bufferUsage = usage
         }
+        
+        onChannelCountChanged: function(channels) {
+            oscilloscopeRoot.createChannelSeries(channels)
+        }
     }
     
     // UI properties
     property bool isRunning: true  // Start with display running
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
-    property var channelEnabled: [true, true, true, true]
-    property var channelColors: ["#00ff00", "#ffff00", "#ff6600", "#ff0088"]
-    property var channelLabels: ["CH1", "CH2", "CH3", "CH4"]
+    // One entry per channel of the backend, rebuilt by createChannelSeries()
+    property var channelSeries: []
+    property var channelEnabled: []
+    property var channelColors: []
+    property var channelLabels: []
+    property var baseColors: ["#00ff00", "#ffff00", "#ff6600", "#ff0088"]
     
-<<<<<<< HEAD
-    // Frame rate properties - handled by backend
-    property real currentFPS: 0
-=======
     // Performance monitoring
     property real currentSampleRate: 1000.0
     property int bufferUsage: 0
     property int updateCount: 0
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
+    property int samplerWindow: 2000  // Sampler samples shown, 2 s at 1 kHz
     
     // Fixed time scale: 0.1s/div
     property real fixedTimeScale: 0.1
@@ -63,10 +59,8 @@ Rectangle {
     property int currentAmplitudeScaleIndex: 6  // Default to 1/div
 
     Component.onCompleted: {
-<<<<<<< HEAD
-        console.log("Simple oscilloscope loaded")
-=======
         console.log("Oscilloscope with SineWaveTest backend loaded")
+        createChannelSeries(sineWaveBackend.channelCount)
         // Start the backend automatically
         sineWaveBackend.start()
     }
@@ -75,39 +69,52 @@ Rectangle {
         sineWaveBackend.stop()
     }
     
-    // Backend data processing
-    function addSamples(timestamps, ch0, ch1, ch2, ch3) {
-        var channels = [channel1, channel2, channel3, channel4]
-        var channelData = [ch0, ch1, ch2, ch3]
+    // The first four channels keep their colours; the rest are spread around the hue circle
+    function channelColor(ch) {
+        if (ch < baseColors.length) return baseColors[ch]
+        return Qt.hsva((ch * 0.618034) % 1.0, 0.8, 1.0, 1.0)
+    }
+    
+    // One line series per channel; existing series and their enable state are kept
+    function createChannelSeries(count) {
+        var series = channelSeries.slice(0, count)
+        var enabled = channelEnabled.slice(0, count)
+        var colors = []
+        var labels = []
         
-        if (timestamps.length === 0) return
+        for (var ch = count; ch < channelSeries.length; ch++)
+            oscilloscopeChart.removeSeries(channelSeries[ch])
         
-        var currentTimeScale = oscilloscopeRoot.timeScales[oscilloscopeRoot.currentTimeScaleIndex]
-        var currentAmplitudeScale = oscilloscopeRoot.amplitudeScales[oscilloscopeRoot.currentAmplitudeScaleIndex]
-        var timeWindow = currentTimeScale * 10
-        
-        // Add new points to each enabled channel
-        for (var ch = 0; ch < 4; ch++) {
-            if (!oscilloscopeRoot.channelEnabled[ch]) continue
-            
-            var series = channels[ch]
-            var data = channelData[ch]
-            
-            // Add all new points
-            for (var i = 0; i < timestamps.length; i++) {
-                var scaledValue = data[i] * currentAmplitudeScale
-                series.append(timestamps[i], scaledValue)
-            }
-            
-            // Remove old points to maintain performance
-            var maxPoints = 1000
-            if (series.count > maxPoints) {
-                series.removePoints(0, series.count - maxPoints)
+        for (ch = 0; ch < count; ch++) {
+            labels.push("CH" + (ch + 1))
+            colors.push(channelColor(ch))
+            if (ch >= series.length) {
+                var line = oscilloscopeChart.createSeries(ChartView.SeriesTypeLine, labels[ch], timeAxis, amplitudeAxis)
+                line.color = colors[ch]
+                line.width = 2
+                line.useOpenGL = openGLSupported
+                series.push(line)
+                enabled.push(true)
             }
+            series[ch].visible = enabled[ch]
         }
         
+        channelSeries = series
+        channelEnabled = enabled
+        channelColors = colors
+        channelLabels = labels
+    }
+    
+    // Backend data processing: the backend appends each channel's new points to
+    // its series itself; only the time axis and the counter are left to do here
+    function flushSamples() {
+        var currentAmplitudeScale = oscilloscopeRoot.amplitudeScales[oscilloscopeRoot.currentAmplitudeScaleIndex]
+        var lastTime = sineWaveBackend.flushToQml(oscilloscopeRoot.channelSeries, currentAmplitudeScale)
+        if (isNaN(lastTime)) return
+        
+        var timeWindow = oscilloscopeRoot.fixedTimeScale * 10
+        
         // Auto-scale time axis
-        var lastTime = timestamps[timestamps.length - 1]
         if (lastTime > timeWindow) {
             timeAxis.min = lastTime - timeWindow
             timeAxis.max = lastTime
@@ -118,7 +125,6 @@ Rectangle {
         
         // Update counter for performance monitoring
         oscilloscopeRoot.updateCount++
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
     }
 
     RowLayout {
@@ -241,41 +247,18 @@ Rectangle {
                     }
                     
                     onClicked: {
-<<<<<<< HEAD
-                        // Clear chart series and reset timer
-                        oscilloscopeChart.series("CH1").clear()
-                        oscilloscopeChart.series("CH2").clear()
-                        oscilloscopeChart.series("CH3").clear()
-                        oscilloscopeChart.series("CH4").clear()
-
-                        timeAxis.max = 2000;  // 2 seconds
-                        timeAxis.min = 0;
-                        
-                        // Timer reset not needed anymore
-                        
-                        // Reset FPS counter
-                        oscilloscopeRoot.currentFPS = 0
-                        
-                        // Reset time axis to initial state
-                        var timeWindow = oscilloscopeRoot.fixedTimeScale * 10  // 0.1 * 10 = 1.0 second
-                        oscilloscopeChart.axisX().min = 0
-                        oscilloscopeChart.axisX().max = timeWindow
-=======
                         // Clear chart series
-                        channel1.clear()
-                        channel2.clear()
-                        channel3.clear()
-                        channel4.clear()
+                        for (var ch = 0; ch < oscilloscopeRoot.channelSeries.length; ch++)
+                            oscilloscopeRoot.channelSeries[ch].clear()
+                        samplerSeries.clear()
                         
                         // Reset counters
                         oscilloscopeRoot.updateCount = 0
                         
                         // Reset time axis to initial state
-                        var currentTimeScale = oscilloscopeRoot.timeScales[oscilloscopeRoot.currentTimeScaleIndex]
-                        var timeWindow = currentTimeScale * 10
+                        var timeWindow = oscilloscopeRoot.fixedTimeScale * 10
                         timeAxis.min = 0
                         timeAxis.max = timeWindow
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
                         
                         console.log("Oscilloscope cleared")
                     }
@@ -301,7 +284,7 @@ Rectangle {
                     spacing: 4
 
                     Repeater {
-                        model: 4
+                        model: oscilloscopeRoot.channelLabels.length
                         delegate: Row {
                             width: parent.width
                             spacing: 8
@@ -329,6 +312,7 @@ Rectangle {
                                         var newChannelEnabled = oscilloscopeRoot.channelEnabled.slice()
                                         newChannelEnabled[index] = checked
                                         oscilloscopeRoot.channelEnabled = newChannelEnabled
+                                        oscilloscopeRoot.channelSeries[index].visible = checked
                                     }
                                 }
 
@@ -532,80 +516,25 @@ Rectangle {
                 titleBrush: Qt.rgba(0, 1, 0, 1)
             }
             
-            // Channel 1
-            LineSeries {
-                id: channel1
-                name: "CH1"
-                axisX: timeAxis
-                axisY: amplitudeAxis
-                color: oscilloscopeRoot.channelColors[0]
-                width: 2
-                visible: oscilloscopeRoot.channelEnabled[0]
-                useOpenGL: openGLSupported
-            }
-            
-            // Channel 2
-            LineSeries {
-                id: channel2
-                name: "CH2"
-                axisX: timeAxis
-                axisY: amplitudeAxis
-                color: oscilloscopeRoot.channelColors[1]
-                width: 2
-                visible: oscilloscopeRoot.channelEnabled[1]
-                useOpenGL: openGLSupported
-            }
-            
-            // Channel 3
-            LineSeries {
-                id: channel3
-                name: "CH3"
-                axisX: timeAxis
-                axisY: amplitudeAxis
-                color: oscilloscopeRoot.channelColors[2]
-                width: 2
-                visible: oscilloscopeRoot.channelEnabled[2]
-                useOpenGL: openGLSupported
+            // Channel series are created by createChannelSeries()
+
+            // Sampler x is its sample index (1 ms at 1 kHz), independent of the backend's seconds
+            ValueAxis {
+                id: samplerTimeAxis
+                min: 0
+                max: oscilloscopeRoot.samplerWindow
+                visible: false
             }
-            
-            // Channel 4
+
             LineSeries {
-                id: channel4
-                name: "CH4"
-                axisX: timeAxis
+                id: samplerSeries
+                name: "Sampler"
+                axisXTop: samplerTimeAxis
                 axisY: amplitudeAxis
-                color: oscilloscopeRoot.channelColors[3]
-                width: 2
-                visible: oscilloscopeRoot.channelEnabled[3]
+                color: "#00ffff"
+                width: 1
                 useOpenGL: openGLSupported
             }
-            
-<<<<<<< HEAD
-            // Timer removed - data updates handled by backend
-        }
-    }
-
-    // Connections to DataSource for real-time data updates
-    Connections {
-        target: dataSource
-
-        function onUpdateCurve() {
-            //console.log("Updating oscilloscope with new data")
-            console.log("Channel1 count: " + channel1.count + " timeAxis max: " + timeAxis.max + " min: " + timeAxis.min)
-
-            // Update time axis (scrolling window)
-            // With 1000Hz sampling (1ms intervals), we get 1000 points per second
-            if(channel1.count >= 2000) { // Start scrolling after 2 seconds of data
-                timeAxis.max += 10;  // Scroll by 20ms
-                timeAxis.min = timeAxis.max - 2000;  // Keep 2 second window
-            }
-
-            // Update the chart series with new data from DataSource
-            if (dataSource && oscilloscopeChart.series("CH1")) {
-                dataSource.update(oscilloscopeChart.series("CH1"));
-                // Debug: console.log("CH1 series updated")
-            }
-=======
         }
     }
     
@@ -618,8 +547,48 @@ Rectangle {
         
         onTriggered: {
             // Flush data from backend to QML
-            sineWaveBackend.flushToQml(oscilloscopeRoot)
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
+            oscilloscopeRoot.flushSamples()
+        }
+    }
+
+    // Links of the vehicle (--link): each link's ADC input on the series of the same index
+    readonly property int vehicleAdcChannel: 7  // CMD_ADC_INPUT, samplerworker.h
+    Connections {
+        target: vehicle
+        enabled: vehicle.linkCount > 0
+
+        function onUpdateCurve() {
+            var links = Math.min(vehicle.linkCount, oscilloscopeRoot.channelSeries.length)
+            for (var link = 0; link < links; link++)
+                vehicle.update(oscilloscopeRoot.channelSeries[link], link, oscilloscopeRoot.vehicleAdcChannel)
+        }
+    }
+
+    // Boards of the fleet (--fleet): likewise, one series per board
+    Connections {
+        target: fleet
+        enabled: fleet.vehicleCount > 0
+
+        function onUpdateCurve() {
+            var boards = Math.min(fleet.vehicleCount, oscilloscopeRoot.channelSeries.length)
+            for (var board = 0; board < boards; board++)
+                fleet.update(oscilloscopeRoot.channelSeries[board], board, oscilloscopeRoot.vehicleAdcChannel)
+        }
+    }
+
+    // The sampler (DataSource) draws on its own series and axis: the backend's
+    // flush owns the channel series and the time axis
+    Connections {
+        target: dataSource
+
+        function onUpdateCurve() {
+            dataSource.update(samplerSeries)
+
+            // Follow the newest point with a window of samplerWindow samples
+            if (samplerSeries.count > 0) {
+                samplerTimeAxis.max = Math.max(samplerSeries.at(samplerSeries.count - 1).x, oscilloscopeRoot.samplerWindow)
+                samplerTimeAxis.min = samplerTimeAxis.max - oscilloscopeRoot.samplerWindow
+            }
         }
     }
 }
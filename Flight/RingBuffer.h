@@ -1,15 +1,63 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 
+#include <algorithm>
 #include <atomic>
 #include <array>
 #include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Up to two contiguous ranges of ring slots, in ring order
+ */
+template<typename U>
+struct RingSpans {
+    U* first = nullptr;
+    size_t first_size = 0;
+    U* second = nullptr;
+    size_t second_size = 0;
+
+    size_t size() const noexcept { return first_size + second_size; }
+    U& operator[](size_t i) const noexcept {
+        return i < first_size ? first[i] : second[i - first_size];
+    }
+};
+
+/**
+ * @brief The same slots in a column stored beside the ring (structure of arrays)
+ *
+ * base is the ring's slot 0 and column must hold as many elements as the ring
+ * has slots.
+ */
+template<typename U, typename V>
+RingSpans<V> columnSpans(const RingSpans<U>& spans, const std::remove_const_t<U>* base, V* column) noexcept {
+    RingSpans<V> result;
+    if (spans.size() == 0) return result;
+    result.first = column + (spans.first - base);
+    result.first_size = spans.first_size;
+    result.second = column;
+    result.second_size = spans.second_size;
+    return result;
+}
 
 /**
  * @brief Lock-free Single Producer Single Consumer (SPSC) ring buffer
  * 
  * High-performance circular buffer optimized for one producer thread and one consumer thread.
  * Uses atomic operations for thread-safe access without locks.
+ *
+ * Each side's index lives on its own cache line together with that side's cached
+ * copy of the other index. The producer only reloads m_tail when the ring looks
+ * full and the consumer only reloads m_head when it looks empty, so in steady
+ * state neither side touches the other's line on every operation.
+ *
+ * Besides element-wise push/pop, reserve()/commit() and peek()/consume() expose
+ * the storage in place as at most two contiguous spans (the second one starts
+ * when the range wraps), so a batch of any size costs one index load at most
+ * and one release store.
+ *
+ * A full ring rejects writes; producers that must never wait use
+ * BroadcastRingBuffer with the Lossy policy instead.
  * 
  * Template parameters:
  * - T: Type of elements stored in the buffer
@@ -22,7 +70,12 @@ class RingBuffer
     static_assert(Size > 1, "Size must be greater than 1");
 
 public:
-    RingBuffer() : m_head(0), m_tail(0) {}
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    typedef RingSpans<T> WriteSpans;
+    typedef RingSpans<const T> ReadSpans;
+
+    RingBuffer() {}
 
     /**
      * @brief Check if buffer is empty (consumer thread)
@@ -71,7 +124,7 @@ public:
         const size_t head = m_head.load(std::memory_order_relaxed);
         const size_t next_head = (head + 1) & (Size - 1);
         
-        if (next_head == m_tail.load(std::memory_order_acquire)) {
+        if (next_head == m_cachedTail && next_head == refreshTail()) {
             return false;  // Buffer is full
         }
         
@@ -87,7 +140,7 @@ public:
         const size_t head = m_head.load(std::memory_order_relaxed);
         const size_t next_head = (head + 1) & (Size - 1);
         
-        if (next_head == m_tail.load(std::memory_order_acquire)) {
+        if (next_head == m_cachedTail && next_head == refreshTail()) {
             return false;  // Buffer is full
         }
         
@@ -104,7 +157,7 @@ public:
     bool pop(T& item) noexcept {
         const size_t tail = m_tail.load(std::memory_order_relaxed);
         
-        if (tail == m_head.load(std::memory_order_acquire)) {
+        if (tail == m_cachedHead && tail == refreshHead()) {
             return false;  // Buffer is empty
         }
         
@@ -122,68 +175,108 @@ public:
     size_t pop_batch(T* items, size_t max_count) noexcept {
         if (!items || max_count == 0) return 0;
         
-        size_t tail = m_tail.load(std::memory_order_relaxed);
-        const size_t head = m_head.load(std::memory_order_acquire);
-        
-        size_t available = (head - tail) & (Size - 1);
-        size_t to_pop = std::min(max_count, available);
-        
-        for (size_t i = 0; i < to_pop; ++i) {
-            items[i] = m_buffer[tail];
-            tail = (tail + 1) & (Size - 1);
-        }
-        
-        m_tail.store(tail, std::memory_order_release);
-        return to_pop;
+        const ReadSpans spans = peek(max_count);
+        std::copy(spans.first, spans.first + spans.first_size, items);
+        std::copy(spans.second, spans.second + spans.second_size, items + spans.first_size);
+        consume(spans.size());
+        return spans.size();
     }
 
     /**
-     * @brief Force push element, dropping oldest if buffer is full (producer thread only)
-     * This ensures the producer never blocks but may lose old data
+     * @brief Reserve up to count free slots for writing in place (producer thread only)
+     * @return Spans covering min(count, free slots); publish them with commit()
      */
-    void force_push(const T& item) noexcept {
+    WriteSpans reserve(size_t count) noexcept {
         const size_t head = m_head.load(std::memory_order_relaxed);
-        const size_t next_head = (head + 1) & (Size - 1);
-        
-        if (next_head == m_tail.load(std::memory_order_acquire)) {
-            // Buffer is full, drop oldest half
-            drop_oldest_half();
+        size_t free_slots = (m_cachedTail - head - 1) & (Size - 1);
+        if (free_slots < count) {
+            free_slots = (refreshTail() - head - 1) & (Size - 1);
         }
-        
-        m_buffer[head] = item;
-        m_head.store(next_head, std::memory_order_release);
+
+        WriteSpans spans;
+        const size_t n = std::min(count, free_slots);
+        spans.first = &m_buffer[head];
+        spans.first_size = std::min(n, Size - head);
+        spans.second = m_buffer.data();
+        spans.second_size = n - spans.first_size;
+        return spans;
     }
 
     /**
-     * @brief Drop oldest half of the buffer to make room (consumer thread only)
-     * Called automatically by force_push when buffer overflows
+     * @brief Publish the first count slots of the last reservation (producer thread only)
      */
-    void drop_oldest_half() noexcept {
-        const size_t current_size = size();
-        const size_t drop_count = current_size / 2;
-        
-        if (drop_count > 0) {
-            const size_t tail = m_tail.load(std::memory_order_relaxed);
-            const size_t new_tail = (tail + drop_count) & (Size - 1);
-            m_tail.store(new_tail, std::memory_order_release);
+    void commit(size_t count) noexcept {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        m_head.store((head + count) & (Size - 1), std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy a run of elements in (producer thread only)
+     * @return Number of elements pushed, less than count if the buffer filled up
+     */
+    size_t push_batch(const T* items, size_t count) noexcept {
+        const WriteSpans spans = reserve(count);
+        std::copy(items, items + spans.first_size, spans.first);
+        std::copy(items + spans.first_size, items + spans.size(), spans.second);
+        commit(spans.size());
+        return spans.size();
+    }
+
+    /**
+     * @brief Look at up to count readable elements in place (consumer thread only)
+     * @return Spans valid until the matching consume()
+     */
+    ReadSpans peek(size_t count = Size) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t available = (m_cachedHead - tail) & (Size - 1);
+        if (available < count) {
+            available = (refreshHead() - tail) & (Size - 1);
         }
+
+        ReadSpans spans;
+        const size_t n = std::min(count, available);
+        spans.first = &m_buffer[tail];
+        spans.first_size = std::min(n, Size - tail);
+        spans.second = m_buffer.data();
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    /**
+     * @brief Release the first count elements of the last peek() (consumer thread only)
+     */
+    void consume(size_t count) noexcept {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_tail.store((tail + count) & (Size - 1), std::memory_order_release);
     }
 
     /**
      * @brief Clear all elements from buffer (consumer thread only)
      */
     void clear() noexcept {
-        m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+        m_tail.store(refreshHead(), std::memory_order_release);
     }
 
 private:
-    std::array<T, Size> m_buffer;
-    std::atomic<size_t> m_head{0};  // Producer writes here
-    std::atomic<size_t> m_tail{0};  // Consumer reads from here
+    // Producer side: reload the consumer's index only when the ring looks full
+    size_t refreshTail() noexcept {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        return m_cachedTail;
+    }
+
+    // Consumer side: reload the producer's index only when the ring looks empty
+    size_t refreshHead() noexcept {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        return m_cachedHead;
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};  // Producer writes here
+    size_t m_cachedTail = 0;                                   // Producer's last view of m_tail
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};  // Consumer reads from here
+    size_t m_cachedHead = 0;                                   // Consumer's last view of m_head
+
+    alignas(CACHE_LINE_SIZE) std::array<T, Size> m_buffer;
 };
 
-<<<<<<< HEAD
-#endif // RINGBUFFER_H
-=======
 #endif // RINGBUFFER_H
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
@@ -0,0 +1,150 @@
+#ifndef RINGSTORAGE_H
+#define RINGSTORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/**
+ * @brief Zero-filled element storage for ring buffers sized at runtime
+ *
+ * Anything of at least one huge page is mapped directly: first from the
+ * hugetlbfs pool (MAP_HUGETLB), which only succeeds when pages have been
+ * reserved through vm.nr_hugepages, otherwise as ordinary anonymous memory
+ * aligned to the huge page size and marked MADV_HUGEPAGE, so transparent huge
+ * pages can back it. A long history then costs one TLB entry per 2 MiB instead
+ * of one per 4 KiB. Smaller allocations, and other platforms, use the heap.
+ *
+ * Nothing throws: when neither the mappings nor the heap can provide the
+ * memory, isNull() is true and the owner must not touch data().
+ */
+template<typename T>
+class RingStorage
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+public:
+    enum Backing {
+        Heap,
+        TransparentHugePages,
+        HugeTlbPages
+    };
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t HEAP_ALIGNMENT = 64;
+
+    explicit RingStorage(size_t count) :
+        m_data(nullptr),
+        m_count(count),
+        m_mapping(nullptr),
+        m_mappedBytes(0),
+        m_backing(Heap)
+    {
+        if (count > SIZE_MAX / sizeof(T)) {
+            m_count = 0;
+            return;
+        }
+        const size_t bytes = count * sizeof(T);
+#ifdef __linux__
+        if (bytes >= HUGE_PAGE_SIZE && mapHugeTlb(bytes))
+            return;
+        if (bytes >= HUGE_PAGE_SIZE && mapTransparent(bytes))
+            return;
+#endif
+        m_data = static_cast<T *>(::operator new(bytes, std::align_val_t(HEAP_ALIGNMENT), std::nothrow));
+        if (!m_data) {
+            m_count = 0;
+            return;
+        }
+        std::memset(static_cast<void *>(m_data), 0, bytes);
+    }
+
+    ~RingStorage()
+    {
+#ifdef __linux__
+        if (m_mapping) {
+            ::munmap(m_mapping, m_mappedBytes);
+            return;
+        }
+#endif
+        ::operator delete(static_cast<void *>(m_data), std::align_val_t(HEAP_ALIGNMENT));
+    }
+
+    RingStorage(const RingStorage &) = delete;
+    RingStorage &operator=(const RingStorage &) = delete;
+
+    bool isNull() const noexcept { return !m_data; }
+    T *data() const noexcept { return m_data; }
+    size_t count() const noexcept { return m_count; }
+    size_t bytes() const noexcept { return m_count * sizeof(T); }
+    Backing backing() const noexcept { return m_backing; }
+
+    const char *backingName() const noexcept
+    {
+        switch (m_backing) {
+        case HugeTlbPages: return "hugetlb pages";
+        case TransparentHugePages: return "transparent huge pages";
+        default: return "heap";
+        }
+    }
+
+private:
+#ifdef __linux__
+    bool mapHugeTlb(size_t bytes)
+    {
+        const size_t length = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        void *mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        m_mapping = mapping;
+        m_mappedBytes = length;
+        m_data = static_cast<T *>(mapping);
+        m_backing = HugeTlbPages;
+        return true;
+    }
+
+    bool mapTransparent(size_t bytes)
+    {
+        // Over-map by one huge page and trim, so the range starts on a huge page boundary
+        const size_t length = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        void *mapping = ::mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        char *begin = static_cast<char *>(mapping);
+        char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1)
+                                                 & ~uintptr_t(HUGE_PAGE_SIZE - 1));
+        if (aligned > begin)
+            ::munmap(begin, size_t(aligned - begin));
+        const size_t tail = size_t(begin + length + HUGE_PAGE_SIZE - (aligned + length));
+        if (tail > 0)
+            ::munmap(aligned + length, tail);
+
+#ifdef MADV_HUGEPAGE
+        ::madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+        m_mapping = aligned;
+        m_mappedBytes = length;
+        m_data = reinterpret_cast<T *>(aligned);
+        m_backing = TransparentHugePages;
+        return true;
+    }
+#endif
+
+    T *m_data;
+    size_t m_count;
+    void *m_mapping;
+    size_t m_mappedBytes;
+    Backing m_backing;
+};
+
+#endif // RINGSTORAGE_H
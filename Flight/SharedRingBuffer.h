@@ -0,0 +1,477 @@
+#ifndef SHAREDRINGBUFFER_H
+#define SHAREDRINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <new>
+#include <string>
+#include <type_traits>
+#include "RingBuffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SHARED_RING_SUPPORTED 1
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SHARED_RING_SUPPORTED 0
+#endif
+
+/**
+ * @brief Layout of the first page of a shared ring segment
+ *
+ * The writer fills in everything else first and stores magic last, so a reader
+ * that sees MAGIC sees a complete header. VERSION changes whenever this layout
+ * or the ring protocol does; readers refuse other versions.
+ *
+ * The slots start at DATA_OFFSET; columns follow them, each capacity elements
+ * long, from columnOffset(). Both depend only on header fields.
+ */
+struct SharedRingHeader {
+    static constexpr uint32_t MAGIC = 0x42524c46;  // "FLRB"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t DATA_OFFSET = 4096;     // Slots start on the second page
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t elementSize;
+    uint32_t columns;
+    uint32_t columnSize;              // Bytes per column element
+    uint32_t reserved;
+    uint64_t capacity;                // Slots, a power of 2
+    uint64_t sessionId;               // Differs for every writer instance
+    std::atomic<int32_t> writerPid;   // 0 once the writer has closed cleanly
+    std::atomic<double> sampleRate;   // Informational, set by the writer
+
+    alignas(64) std::atomic<uint64_t> head;         // Published end of the stream
+    std::atomic<uint64_t> claim;                    // End of the range being written
+    std::atomic<int64_t> heartbeatNs;               // CLOCK_MONOTONIC of the last commit or heartbeat()
+
+    static size_t columnOffset(uint64_t capacity, uint32_t elementSize) {
+        return (DATA_OFFSET + size_t(capacity) * elementSize + 63) & ~size_t(63);
+    }
+    static size_t segmentSize(uint64_t capacity, uint32_t elementSize, uint32_t columns, uint32_t columnSize) {
+        return columnOffset(capacity, elementSize) + size_t(columns) * size_t(capacity) * columnSize;
+    }
+};
+
+static_assert(sizeof(SharedRingHeader) <= SharedRingHeader::DATA_OFFSET, "Header must fit in the first page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared atomics must be lock-free");
+static_assert(std::atomic<double>::is_always_lock_free, "Shared atomics must be lock-free");
+
+inline int64_t sharedRingNowNs()
+{
+#if SHARED_RING_SUPPORTED
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Writing end of a ring in POSIX shared memory (one per segment)
+ *
+ * The segment is named (shm_open), so an acquisition process and any number of
+ * GUI processes find it without passing descriptors around. Readers map it
+ * read-only and keep their cursors to themselves, so the writer never waits on
+ * them: the protocol is that of BroadcastRingBuffer's Lossy policy (claim before
+ * writing, readers check before and after reading).
+ *
+ * Each slot may carry columns of Column values, stored after the slots one
+ * column at a time (columnSpans()), so the channel count is set per segment.
+ *
+ * Creating a segment replaces a previous one of that name whose writer is gone
+ * (closed, dead, or silent for TAKEOVER_STALE_NS, so a reused pid does not keep
+ * it); readers of the old one see that and re-attach. While its writer is alive
+ * create() fails with EEXIST instead. POSIX only: elsewhere create() fails with
+ * ENOSYS.
+ */
+template<typename T, typename Column = float>
+class SharedRingWriter
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Column>::value, "Column must be trivially copyable");
+
+public:
+    typedef RingSpans<T> WriteSpans;
+
+    static constexpr int64_t TAKEOVER_STALE_NS = 5000000000;
+
+    SharedRingWriter() : m_header(nullptr), m_buffer(nullptr), m_columns(nullptr), m_columnCount(0), m_size(0), m_mappedBytes(0) {}
+    ~SharedRingWriter() { close(); }
+
+    SharedRingWriter(const SharedRingWriter &) = delete;
+    SharedRingWriter &operator=(const SharedRingWriter &) = delete;
+
+    /**
+     * @brief Create the segment /name with room for capacity slots (rounded up to a power of 2) and their columns
+     * @return false with errno set if the segment could not be created
+     */
+    bool create(const std::string &name, size_t capacity, int columns = 0) {
+        close();
+#if SHARED_RING_SUPPORTED
+        m_name = name.compare(0, 1, "/") == 0 ? name : "/" + name;
+
+        m_size = 2;
+        while (m_size < capacity)
+            m_size <<= 1;
+        m_columnCount = columns;
+        m_mappedBytes = SharedRingHeader::segmentSize(m_size, sizeof(T), uint32_t(columns), sizeof(Column));
+
+        if (writerAlive(m_name)) {
+            errno = EEXIST;
+            return false;
+        }
+        shm_unlink(m_name.c_str());  // A dead writer's segment; its readers keep their mapping
+        const int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, off_t(m_mappedBytes)) < 0) {
+            const int error = errno;
+            ::close(fd);
+            shm_unlink(m_name.c_str());
+            errno = error;
+            return false;
+        }
+        void *mapping = mmap(nullptr, m_mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            shm_unlink(m_name.c_str());
+            return false;
+        }
+
+        m_header = new (mapping) SharedRingHeader;  // Placement-new on zero-filled pages
+        m_buffer = reinterpret_cast<T *>(static_cast<char *>(mapping) + SharedRingHeader::DATA_OFFSET);
+        m_columns = reinterpret_cast<Column *>(static_cast<char *>(mapping) + SharedRingHeader::columnOffset(m_size, sizeof(T)));
+        m_header->version = SharedRingHeader::VERSION;
+        m_header->elementSize = uint32_t(sizeof(T));
+        m_header->columns = uint32_t(columns);
+        m_header->columnSize = uint32_t(sizeof(Column));
+        m_header->capacity = m_size;
+        m_header->sessionId = uint64_t(sharedRingNowNs()) ^ (uint64_t(getpid()) << 32);
+        m_header->writerPid.store(int32_t(getpid()), std::memory_order_relaxed);
+        m_header->sampleRate.store(0.0, std::memory_order_relaxed);
+        m_header->head.store(0, std::memory_order_relaxed);
+        m_header->claim.store(0, std::memory_order_relaxed);
+        m_header->heartbeatNs.store(sharedRingNowNs(), std::memory_order_relaxed);
+        m_header->magic.store(SharedRingHeader::MAGIC, std::memory_order_release);
+        return true;
+#else
+        (void)name;
+        (void)capacity;
+        (void)columns;
+        errno = ENOSYS;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Mark the stream closed for readers, unmap and remove the name
+     */
+    void close() {
+        if (!m_header)
+            return;
+        m_header->writerPid.store(0, std::memory_order_release);
+#if SHARED_RING_SUPPORTED
+        munmap(m_header, m_mappedBytes);
+        shm_unlink(m_name.c_str());
+#endif
+        m_header = nullptr;
+        m_buffer = nullptr;
+        m_columns = nullptr;
+    }
+
+    bool isOpen() const noexcept { return m_header != nullptr; }
+    size_t capacity() const noexcept { return m_size; }
+    int columns() const noexcept { return m_columnCount; }
+    const std::string &name() const noexcept { return m_name; }
+
+    void setSampleRate(double rate) noexcept {
+        m_header->sampleRate.store(rate, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Claim the next min(count, capacity()) slots for writing in place
+     */
+    WriteSpans reserve(size_t count) noexcept {
+        const uint64_t head = m_header->head.load(std::memory_order_relaxed);
+        const size_t n = std::min(count, m_size);
+
+        if (head + n > m_header->claim.load(std::memory_order_relaxed))
+            m_header->claim.store(head + n, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);  // Claim is visible before any slot changes
+
+        WriteSpans spans;
+        const size_t index = size_t(head) & (m_size - 1);
+        spans.first = m_buffer + index;
+        spans.first_size = std::min(n, m_size - index);
+        spans.second = m_buffer;
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    /**
+     * @brief The slots of spans from reserve() in column c
+     */
+    RingSpans<Column> columnSpans(const WriteSpans &spans, int c) noexcept {
+        return ::columnSpans(spans, m_buffer, m_columns + size_t(c) * m_size);
+    }
+
+    /**
+     * @brief Publish the first count slots of the last reservation; doubles as a heartbeat
+     */
+    void commit(size_t count) noexcept {
+        m_header->head.store(m_header->head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        heartbeat();
+    }
+
+    /**
+     * @brief Tell readers the writer is alive while it has nothing to publish
+     */
+    void heartbeat() noexcept {
+        m_header->heartbeatNs.store(sharedRingNowNs(), std::memory_order_relaxed);
+    }
+
+private:
+#if SHARED_RING_SUPPORTED
+    // Is the segment at path still written to? Only its header is looked at
+    static bool writerAlive(const std::string &path) {
+        const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        bool alive = false;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= SharedRingHeader::DATA_OFFSET) {
+            void *mapping = mmap(nullptr, SharedRingHeader::DATA_OFFSET, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping != MAP_FAILED) {
+                const SharedRingHeader *header = static_cast<const SharedRingHeader *>(mapping);
+                const int32_t pid = header->writerPid.load(std::memory_order_acquire);
+                alive = header->magic.load(std::memory_order_acquire) == SharedRingHeader::MAGIC
+                        && header->version == SharedRingHeader::VERSION
+                        && pid != 0
+                        && (kill(pid, 0) == 0 || errno == EPERM)
+                        && sharedRingNowNs() - header->heartbeatNs.load(std::memory_order_relaxed) <= TAKEOVER_STALE_NS;
+                munmap(mapping, SharedRingHeader::DATA_OFFSET);
+            }
+        }
+        ::close(fd);
+        return alive;
+    }
+#endif
+
+    std::string m_name;
+    SharedRingHeader *m_header;
+    T *m_buffer;
+    Column *m_columns;
+    int m_columnCount;
+    size_t m_size;
+    size_t m_mappedBytes;
+};
+
+/**
+ * @brief Read-only view of a shared ring segment, with its own cursor
+ *
+ * Samples are read in place from the mapping (zero copies); the usual
+ * peek()/consume() pair reports the ones the writer overwrote meanwhile.
+ */
+template<typename T, typename Column = float>
+class SharedRingReader
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    static_assert(std::is_trivially_copyable<Column>::value, "Column must be trivially copyable");
+
+public:
+    typedef RingSpans<const T> ReadSpans;
+
+    enum WriterState {
+        Alive,
+        Stalled,   // Process exists but has not committed or sent a heartbeat lately
+        Closed,    // Writer shut down cleanly
+        Dead       // Writer process is gone
+    };
+
+    SharedRingReader() :
+        m_header(nullptr), m_buffer(nullptr), m_columns(nullptr), m_size(0), m_mappedBytes(0), m_cursor(0), m_dropped(0) {}
+    ~SharedRingReader() { detach(); }
+
+    SharedRingReader(const SharedRingReader &) = delete;
+    SharedRingReader &operator=(const SharedRingReader &) = delete;
+
+    /**
+     * @brief Map the segment /name read-only and start reading at its head
+     * @return false if it does not exist or was made by an incompatible writer
+     */
+    bool attach(const std::string &name) {
+        detach();
+#if SHARED_RING_SUPPORTED
+        const std::string path = name.compare(0, 1, "/") == 0 ? name : "/" + name;
+
+        const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || size_t(st.st_size) < SharedRingHeader::DATA_OFFSET) {
+            ::close(fd);
+            return false;
+        }
+        void *mapping = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        const SharedRingHeader *header = static_cast<const SharedRingHeader *>(mapping);
+        const bool compatible = header->magic.load(std::memory_order_acquire) == SharedRingHeader::MAGIC
+                                && header->version == SharedRingHeader::VERSION
+                                && header->elementSize == sizeof(T)
+                                && (header->columns == 0 || header->columnSize == sizeof(Column))
+                                && SharedRingHeader::segmentSize(header->capacity, sizeof(T), header->columns,
+                                                                 sizeof(Column)) <= size_t(st.st_size);
+        if (!compatible) {
+            munmap(mapping, size_t(st.st_size));
+            errno = EPROTO;
+            return false;
+        }
+
+        m_header = header;
+        m_buffer = reinterpret_cast<const T *>(static_cast<const char *>(mapping) + SharedRingHeader::DATA_OFFSET);
+        m_columns = reinterpret_cast<const Column *>(static_cast<const char *>(mapping)
+                                                     + SharedRingHeader::columnOffset(header->capacity, sizeof(T)));
+        m_size = size_t(header->capacity);
+        m_mappedBytes = size_t(st.st_size);
+        m_cursor = header->head.load(std::memory_order_acquire);
+        m_dropped = 0;
+        return true;
+#else
+        (void)name;
+        errno = ENOSYS;
+        return false;
+#endif
+    }
+
+    void detach() {
+        if (!m_header)
+            return;
+#if SHARED_RING_SUPPORTED
+        munmap(const_cast<SharedRingHeader *>(m_header), m_mappedBytes);
+#endif
+        m_header = nullptr;
+        m_buffer = nullptr;
+        m_columns = nullptr;
+    }
+
+    bool isAttached() const noexcept { return m_header != nullptr; }
+    size_t capacity() const noexcept { return m_size; }
+    int columns() const noexcept { return m_header ? int(m_header->columns) : 0; }
+    uint64_t sessionId() const noexcept { return m_header ? m_header->sessionId : 0; }
+    double sampleRate() const noexcept { return m_header ? m_header->sampleRate.load(std::memory_order_relaxed) : 0.0; }
+    uint64_t dropped() const noexcept { return m_dropped; }
+
+    /**
+     * @brief Samples published but not read yet
+     */
+    size_t size() const noexcept {
+        if (!m_header) return 0;
+        const uint64_t head = m_header->head.load(std::memory_order_acquire);
+        return size_t(std::min<uint64_t>(head - std::min(head, m_cursor), m_size));
+    }
+
+    double usage() const noexcept {
+        return m_size ? double(size()) / double(m_size) : 0.0;
+    }
+
+    /**
+     * @brief Is anybody still writing? A heartbeat older than staleNs counts as stalled
+     */
+    WriterState writerState(int64_t staleNs) const noexcept {
+        if (!m_header)
+            return Closed;
+        const int32_t pid = m_header->writerPid.load(std::memory_order_acquire);
+        if (pid == 0)
+            return Closed;
+#if SHARED_RING_SUPPORTED
+        if (kill(pid, 0) < 0 && errno == ESRCH)
+            return Dead;
+#endif
+        if (sharedRingNowNs() - m_header->heartbeatNs.load(std::memory_order_relaxed) > staleNs)
+            return Stalled;
+        return Alive;
+    }
+
+    /**
+     * @brief Look at up to count unread samples in place; lapped ones are skipped and counted
+     */
+    ReadSpans peek(size_t count = SIZE_MAX) noexcept {
+        ReadSpans spans;
+        if (!m_header)
+            return spans;
+
+        const uint64_t head = m_header->head.load(std::memory_order_acquire);
+        const uint64_t oldest = oldestIntact(m_header->claim.load(std::memory_order_acquire));
+        if (m_cursor < oldest) {
+            m_dropped += oldest - m_cursor;
+            m_cursor = oldest;
+        }
+
+        const size_t n = size_t(std::min<uint64_t>(count, head - std::min(head, m_cursor)));
+        const size_t index = size_t(m_cursor) & (m_size - 1);
+        spans.first = m_buffer + index;
+        spans.first_size = std::min(n, m_size - index);
+        spans.second = m_buffer;
+        spans.second_size = n - spans.first_size;
+        return spans;
+    }
+
+    /**
+     * @brief The slots of spans from peek() in column c
+     */
+    RingSpans<const Column> columnSpans(const ReadSpans &spans, int c) const noexcept {
+        return ::columnSpans(spans, m_buffer, m_columns + size_t(c) * m_size);
+    }
+
+    /**
+     * @brief Move past the first count samples of the last peek()
+     * @return How many of those, from the front, were overwritten while being read
+     */
+    size_t consume(size_t count) noexcept {
+        if (!m_header)
+            return 0;
+        std::atomic_thread_fence(std::memory_order_acquire);  // Slot reads complete before the recheck
+        const uint64_t oldest = oldestIntact(m_header->claim.load(std::memory_order_relaxed));
+        const size_t torn = m_cursor < oldest ? size_t(std::min<uint64_t>(count, oldest - m_cursor)) : 0;
+        m_dropped += torn;
+        m_cursor += count;
+        return torn;
+    }
+
+    /**
+     * @brief Skip everything unread and reset the drop counter
+     */
+    void clear() noexcept {
+        if (m_header)
+            m_cursor = m_header->head.load(std::memory_order_acquire);
+        m_dropped = 0;
+    }
+
+private:
+    uint64_t oldestIntact(uint64_t claim) const noexcept {
+        return claim > m_size ? claim - m_size : 0;
+    }
+
+    const SharedRingHeader *m_header;
+    const T *m_buffer;
+    const Column *m_columns;
+    size_t m_size;
+    size_t m_mappedBytes;
+    uint64_t m_cursor;
+    uint64_t m_dropped;
+};
+
+#endif // SHAREDRINGBUFFER_H
@@ -0,0 +1,98 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Latest-value exchange from one writer thread to one reader thread
+ *
+ * Three slots: the writer fills its back slot and swaps it with the middle one,
+ * the reader swaps the middle one with its front slot when the middle holds
+ * something newer. Each side only ever touches the slot it owns, so values
+ * with heap members (vectors, strings) pass without a lock and without a torn
+ * copy, and neither side waits on the other. Values the reader never picked up
+ * are replaced by newer ones.
+ *
+ * Every publish() gets the next version number; the reader's poll costs one
+ * relaxed load while nothing new is there.
+ *
+ * Template parameters:
+ * - T: Type of the value (default-constructible, copy-assignable)
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    TripleBuffer() :
+        m_middle(1),
+        m_version(0),
+        m_back(2),
+        m_front(0)
+    {
+        for (Slot &slot : m_slots)
+            slot.version = 0;
+    }
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    /**
+     * @brief Make value the latest (writer thread)
+     * @return Its version, counting from 1
+     */
+    uint64_t publish(const T &value) {
+        Slot &slot = m_slots[m_back];
+        slot.value = value;
+        slot.version = ++m_version;
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+        return m_version;
+    }
+
+    /**
+     * @brief Take the latest value if there is a newer one than front() (reader thread)
+     * @return true if front() changed
+     */
+    bool update() noexcept {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Value taken by the last update(), the reader's until the next one (reader thread)
+     */
+    const T &front() const noexcept { return m_slots[m_front].value; }
+
+    /**
+     * @brief Version of front(); 0 before anything was taken (reader thread)
+     */
+    uint64_t frontVersion() const noexcept { return m_slots[m_front].version; }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 3;
+    static constexpr uint32_t FRESH = 4;  // Middle slot not taken yet
+
+    struct Slot {
+        T value;
+        uint64_t version;
+    };
+
+    // Middle slot index and FRESH, the only state both sides touch
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_middle;
+
+    // Writer side
+    alignas(CACHE_LINE_SIZE) uint64_t m_version;
+    uint32_t m_back;
+
+    // Reader side
+    alignas(CACHE_LINE_SIZE) uint32_t m_front;
+
+    Slot m_slots[3];
+};
+
+#endif // TRIPLEBUFFER_H
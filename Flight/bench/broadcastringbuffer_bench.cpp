@@ -0,0 +1,234 @@
+// Lossy BroadcastRingBuffer with lapped readers: single-threaded, one reader
+// keeping up while another is lapped before peek() and between peek() and
+// consume(); then a producer thread racing two reader threads that peek and
+// consume runs of random length. Each slot carries a column holding the
+// complement of its value. Every delivered sample must be the one expected after
+// that reader's drops, with its column intact, nothing is read past capacity(),
+// and each reader's delivered + dropped equals produced. wait_for() must time
+// out on an empty ring and, while the producer publishes in bursts, wake a
+// blocked reader without ever missing one (a lost wakeup shows as a timeout).
+// Exits 1 on a failure.
+//
+//   broadcastringbuffer_bench [samples] [capacity]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+#include "BroadcastRingBuffer.h"
+
+namespace {
+
+typedef BroadcastRingBuffer<uint64_t, uint64_t> Ring;
+
+int g_failures = 0;
+
+void check(bool ok, const char *what)
+{
+    if (!ok) {
+        std::printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+void push(Ring &ring, uint64_t first, size_t count)
+{
+    while (count > 0) {
+        const Ring::WriteSpans spans = ring.reserve(count);
+        const RingSpans<uint64_t> column = ring.columnSpans(spans, 0);
+        for (size_t i = 0; i < spans.size(); i++) {
+            spans[i] = first + i;
+            column[i] = ~(first + i);
+        }
+        ring.commit(spans.size());
+        first += spans.size();
+        count -= spans.size();
+    }
+}
+
+void checkLapped()
+{
+    Ring ring(64, Ring::Lossy, 1);
+    const int fast = ring.addReader();
+    const int slow = ring.addReader();
+
+    // The fast reader keeps up while the slow one is lapped
+    for (uint64_t i = 0; i < 1000; i += 40) {
+        push(ring, i, 40);
+        const Ring::ReadSpans spans = ring.peek(fast);
+        check(spans.size() == 40 && spans[0] == i, "a reader that keeps up sees every sample");
+        check(ring.consume(fast, spans.size()) == 0, "a reader that keeps up is never torn");
+    }
+    check(ring.dropped(fast) == 0, "a reader that keeps up drops nothing");
+
+    Ring::ReadSpans spans = ring.peek(slow);
+    check(spans.size() == ring.capacity(), "peek after a lap returns one capacity");
+    check(ring.dropped(slow) == 1000 - ring.capacity(), "peek counts the lapped samples");
+    check(spans[0] == 1000 - ring.capacity() && spans[spans.size() - 1] == 999, "peek starts at the oldest intact sample");
+    check(ring.columnSpans(spans, 0)[0] == ~spans[0], "the column moves with its slot");
+    check(ring.consume(slow, spans.size()) == 0, "nothing torn without a write in between");
+
+    // Lapped between peek() and consume(): the front of the range is torn
+    push(ring, 1000, 64);
+    spans = ring.peek(slow);
+    push(ring, 1064, 10);
+    const uint64_t droppedBefore = ring.dropped(slow);
+    check(ring.consume(slow, spans.size()) == 10, "consume reports the overwritten front");
+    check(ring.dropped(slow) == droppedBefore + 10, "torn samples are counted as dropped");
+
+    // Lapped many times over, then a reader registered late starts at the head
+    push(ring, 1074, 100 * ring.capacity());
+    spans = ring.peek(slow, SIZE_MAX);
+    check(spans.size() == ring.capacity(), "peek never hands out more than capacity");
+    check(spans[0] == 1074 + 99 * ring.capacity(), "peek after many laps starts at the oldest intact sample");
+    const int late = ring.addReader();
+    check(ring.peek(late).size() == 0, "a new reader starts at the head");
+}
+
+void checkWait()
+{
+    Ring ring(256, Ring::Lossy, 1);
+    const int idle = ring.addReader();
+    const int waiter = ring.addReader();
+
+    const auto start = std::chrono::steady_clock::now();
+    check(ring.wait_for(idle, 1, std::chrono::milliseconds(20)) == 0, "wait_for() on an empty ring returns nothing");
+    check(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20), "wait_for() waits out its timeout");
+
+    // The reader alternates between waiting for one sample and for four
+    const uint64_t total = 5000;
+    int timeouts = 0;
+    bool ordered = true;
+    std::thread reader([&]() {
+        uint64_t expected = 0;
+        for (int round = 0; expected < total; round++) {
+            const size_t want = std::min<uint64_t>(round % 2 ? 4 : 1, total - expected);
+            if (ring.wait_for(waiter, want, std::chrono::seconds(1)) < want)
+                timeouts++;
+            const Ring::ReadSpans spans = ring.peek(waiter);
+            for (size_t i = 0; i < spans.size(); i++)
+                ordered = ordered && spans[i] == expected + i;
+            ring.consume(waiter, spans.size());
+            expected += spans.size();
+            if (timeouts > 0)
+                break;
+        }
+    });
+    std::mt19937 random(3);
+    for (uint64_t next = 0; next < total;) {
+        const size_t n = std::min<uint64_t>(total - next, 1 + random() % 4);
+        push(ring, next, n);
+        next += n;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    reader.join();
+    check(timeouts == 0, "a reader blocked in wait_for() is woken by every commit that reaches its target");
+    check(ordered, "a woken reader sees every sample in order");
+}
+
+struct ReaderResult {
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    bool ok = true;
+};
+
+void readLoop(Ring &ring, int id, const std::atomic<bool> &done, unsigned seed, ReaderResult &result)
+{
+    std::mt19937 random(seed);
+    std::vector<uint64_t> values(ring.capacity());
+    std::vector<uint64_t> column(ring.capacity());
+    uint64_t expected = 0;
+
+    for (;;) {
+        const bool finished = done.load(std::memory_order_acquire);
+        const uint64_t droppedBefore = ring.dropped(id);
+        const size_t count = random() % 4 == 0 ? SIZE_MAX : 1 + random() % ring.capacity();
+        const Ring::ReadSpans spans = ring.peek(id, count);
+        const size_t n = spans.size();
+        if (n > ring.capacity()) {
+            std::printf("FAIL: reader %d was handed %zu samples of a ring of %zu\n", id, n, ring.capacity());
+            result.ok = false;
+            return;
+        }
+        const RingSpans<const uint64_t> columnSpans = ring.columnSpans(spans, 0);
+        for (size_t i = 0; i < n; i++) {
+            values[i] = spans[i];
+            column[i] = columnSpans[i];
+        }
+        const size_t torn = ring.consume(id, n);
+
+        // Intact samples follow on from the last delivered one, past whatever was dropped since
+        expected += ring.dropped(id) - droppedBefore;
+        for (size_t i = torn; i < n; i++, expected++) {
+            if (values[i] != expected || column[i] != ~expected) {
+                std::printf("FAIL: reader %d delivered %llu where %llu was expected\n",
+                            id, static_cast<unsigned long long>(values[i]), static_cast<unsigned long long>(expected));
+                result.ok = false;
+                return;
+            }
+        }
+        result.delivered += n - torn;
+        if (n == 0 && finished)
+            break;
+    }
+    result.dropped = ring.dropped(id);
+}
+
+bool checkConcurrent(uint64_t samples, size_t capacity)
+{
+    Ring ring(capacity, Ring::Lossy, 1);
+    const int readers[2] = {ring.addReader(), ring.addReader()};
+    ReaderResult results[2];
+    std::atomic<bool> done{false};
+
+    std::thread threads[2];
+    for (int r = 0; r < 2; r++)
+        threads[r] = std::thread(readLoop, std::ref(ring), readers[r], std::cref(done), unsigned(r + 2), std::ref(results[r]));
+
+    std::mt19937 random(1);
+    for (uint64_t next = 0; next < samples;) {
+        const size_t n = std::min<uint64_t>(samples - next, 1 + random() % (2 * ring.capacity()));
+        push(ring, next, n);
+        next += n;
+        if (random() % 8 == 0)
+            std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+
+    bool ok = true;
+    for (int r = 0; r < 2; r++) {
+        threads[r].join();
+        std::printf("concurrent reader %d: %llu samples through a ring of %zu, %llu delivered, %llu dropped\n",
+                    readers[r], static_cast<unsigned long long>(samples), ring.capacity(),
+                    static_cast<unsigned long long>(results[r].delivered),
+                    static_cast<unsigned long long>(results[r].dropped));
+        if (results[r].ok && results[r].delivered + results[r].dropped != samples) {
+            std::printf("FAIL: delivered + dropped != produced\n");
+            results[r].ok = false;
+        }
+        ok = ok && results[r].ok;
+    }
+    return ok;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const uint64_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000ULL;
+    const size_t capacity = argc > 2 ? size_t(std::atoll(argv[2])) : 256;
+
+    checkLapped();
+    std::printf("lapped readers: %s\n", g_failures == 0 ? "ok" : "FAILED");
+    checkWait();
+    std::printf("wait_for: %s\n", g_failures == 0 ? "ok" : "FAILED");
+    if (!checkConcurrent(samples, capacity))
+        g_failures++;
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// IioSource without an ADC. First the block decoder against a scalar reference
+// for unsigned and signed 12/16-bit samples with shifts 0 and 4, which takes
+// the SSE2/NEON path where there is one. Then a FIFO stands in for
+// /dev/iio:deviceN: a writer thread streams a ramp through it and the source
+// must deliver every sample intact. Prints the FIFO rate in MS/s.
+//
+//   iiosource_bench [samples]
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "iiosource.h"
+
+namespace {
+
+const size_t DECODE_SCANS = 1001;  // Not a multiple of the vector width, so the tail runs too
+const int DECODE_CHANNELS = 3;
+const char *const FIFO_PATH = "/tmp/iiosource_bench.fifo";
+
+struct CollectingSink : public SourceSink {
+    std::vector<TelemetrySample> samples;
+
+    void chunkReceived(const quint8 *, qint64, qint64) override {}
+    void samplesReceived(const TelemetrySample *received, int count) override
+    {
+        samples.insert(samples.end(), received, received + count);
+    }
+};
+
+// Little-endian 16-bit storage, realbits of it after a right shift
+float reference(const quint8 *src, bool isSigned, int realBits, int shift)
+{
+    const quint32 raw = quint32(src[0] | (src[1] << 8));
+    const quint32 value = (raw >> shift) & ((1u << realBits) - 1);
+    if (isSigned && ((value >> (realBits - 1)) & 1))
+        return float(int(value) - (1 << realBits));
+    return float(value);
+}
+
+bool checkDecoder()
+{
+    std::mt19937 rng(1);
+    for (bool isSigned : {false, true}) {
+        for (int realBits : {12, 16}) {
+            for (int shift : {0, 4}) {
+                if (realBits + shift > 16)
+                    continue;
+
+                IioScanLayout layout;
+                char type[32];
+                std::snprintf(type, sizeof(type), "le:%c%d/16>>%d", isSigned ? 's' : 'u', realBits, shift);
+                for (int c = 0; c < DECODE_CHANNELS; c++) {
+                    IioChannel channel;
+                    channel.index = c;
+                    if (!channel.parseType(type)) {
+                        std::fprintf(stderr, "Cannot parse %s\n", type);
+                        return false;
+                    }
+                    layout.channels.append(channel);
+                }
+                layout.finalize();
+
+                std::vector<quint8> raw(DECODE_SCANS * DECODE_CHANNELS * 2);
+                for (quint8 &byte : raw)
+                    byte = quint8(rng());
+                std::vector<float> decoded(DECODE_SCANS * DECODE_CHANNELS);
+                IioSource::decodeScans(raw.data(), decoded.data(), DECODE_SCANS, layout);
+
+                for (size_t i = 0; i < decoded.size(); i++) {
+                    if (decoded[i] != reference(&raw[2 * i], isSigned, realBits, shift)) {
+                        std::fprintf(stderr, "%s: mismatch at %zu\n", type, i);
+                        return false;
+                    }
+                }
+                std::printf("decode %-14s ok\n", type);
+            }
+        }
+    }
+    return true;
+}
+
+bool checkFifo(int samples)
+{
+    unlink(FIFO_PATH);
+    if (mkfifo(FIFO_PATH, 0600) != 0) {
+        std::perror("mkfifo");
+        return false;
+    }
+
+    IioScanLayout layout;
+    IioChannel channel;
+    channel.index = 1;
+    channel.parseType("le:u12/16>>0");
+    layout.channels.append(channel);
+    IioSource source(FIFO_PATH, layout, 100000.0);
+
+    std::thread writer([samples]() {
+        const int fd = open(FIFO_PATH, O_WRONLY);
+        std::vector<quint16> ramp(static_cast<size_t>(samples));
+        for (int i = 0; i < samples; i++)
+            ramp[size_t(i)] = quint16(i & 4095);
+        const char *bytes = reinterpret_cast<const char *>(ramp.data());
+        for (size_t offset = 0, size = ramp.size() * 2; offset < size;) {
+            const ssize_t written = write(fd, bytes + offset, std::min<size_t>(4096, size - offset));
+            if (written > 0)
+                offset += size_t(written);
+        }
+        close(fd);
+    });
+
+    if (!source.open()) {
+        writer.detach();
+        return false;
+    }
+    CollectingSink sink;
+    const qint64 startNs = HostClock::nowNs();
+    while (sink.samples.size() < size_t(samples))
+        source.poll(sink, 100);
+    const qint64 elapsedNs = HostClock::nowNs() - startNs;
+    writer.join();
+    unlink(FIFO_PATH);
+
+    for (int i = 0; i < samples; i++) {
+        const TelemetrySample &sample = sink.samples[size_t(i)];
+        if (sample.value != float(i & 4095) || sample.channel != 1) {
+            std::fprintf(stderr, "FIFO sample %d damaged\n", i);
+            return false;
+        }
+    }
+    std::printf("fifo   %d samples intact, %.1f MS/s\n", samples, double(samples) * 1e3 / double(elapsedNs));
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const int samples = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    return checkDecoder() && checkFifo(samples) ? 0 : 1;
+}
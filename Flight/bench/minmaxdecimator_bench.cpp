@@ -0,0 +1,184 @@
+// MinMaxDecimator throughput on one core, against the stride pick flushToQml
+// used before (every n-th sample) and a plain scalar min/max loop. 4 and 32
+// channels, a bucket of one display point at 1 MS/s and a small one, in
+// millions of channel values per second consumed.
+//
+// First checks that a falling and a rising ramp, fed whole and in runs that
+// split the buckets, come out as falling and rising points: each bucket's
+// extremes in the order they occurred. Exits 1 on a failure.
+//
+//   minmaxdecimator_bench [seconds per case]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+#include "minmaxdecimator.h"
+
+namespace {
+
+const size_t BATCH = 1 << 16;
+
+int g_failures = 0;
+
+void check(bool ok, const char *what)
+{
+    if (!ok) {
+        std::printf("FAIL: %s\n", what);
+        g_failures++;
+    }
+}
+
+void checkOrder()
+{
+    const size_t count = 1000;
+    const size_t bucket = 10;
+    std::vector<double> t(count);
+    std::vector<float> falling(count), rising(count);
+    for (size_t i = 0; i < count; i++) {
+        t[i] = double(i);
+        falling[i] = float(count - i);
+        rising[i] = float(i);
+    }
+
+    for (size_t run : {count, size_t(7), size_t(3)}) {
+        MinMaxDecimator decimator;
+        decimator.reset(2, bucket);
+        for (size_t done = 0; done < count; done += run) {
+            const float *y[2] = {falling.data() + done, rising.data() + done};
+            decimator.add(t.data() + done, y, std::min(run, count - done));
+        }
+        check(decimator.pointCount() == 2 * count / bucket, "two points per bucket");
+
+        bool fallingOk = true, risingOk = true;
+        for (size_t i = 1; i < decimator.pointCount(); i++) {
+            fallingOk = fallingOk && decimator.values(0)[i] < decimator.values(0)[i - 1];
+            risingOk = risingOk && decimator.values(1)[i] > decimator.values(1)[i - 1];
+        }
+        check(fallingOk, "a falling ramp is drawn falling, maximum before minimum");
+        check(risingOk, "a rising ramp is drawn rising, minimum before maximum");
+        check(decimator.values(0)[0] == falling[0] && decimator.values(0)[1] == falling[bucket - 1],
+              "a falling bucket starts at its first sample and ends at its last");
+    }
+}
+
+struct Input {
+    std::vector<double> t;
+    std::vector<std::vector<float>> columns;
+    std::vector<const float *> y;
+
+    explicit Input(int channels) : t(BATCH), columns(size_t(channels), std::vector<float>(BATCH))
+    {
+        std::mt19937 rng(1);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        for (size_t i = 0; i < BATCH; i++)
+            t[i] = double(i) * 1e-6;
+        for (std::vector<float> &column : columns) {
+            for (float &value : column)
+                value = noise(rng);
+            y.push_back(column.data());
+        }
+    }
+};
+
+// The previous decimation, every bucket-th sample
+struct StridePick {
+    std::vector<std::vector<float>> points;
+    size_t next = 0;
+
+    void run(const Input &input, size_t bucket)
+    {
+        points.resize(input.columns.size());
+        for (size_t c = 0; c < input.columns.size(); c++) {
+            points[c].clear();
+            for (size_t i = next; i < BATCH; i += bucket)
+                points[c].push_back(input.y[c][i]);
+        }
+        next = (next + (BATCH - next + bucket - 1) / bucket * bucket) - BATCH;
+    }
+    float checksum() const { return points[0].empty() ? 0.0f : points[0][0]; }
+};
+
+// Min/max per bucket, one sample at a time
+struct ScalarMinMax {
+    std::vector<std::vector<float>> points;
+
+    void run(const Input &input, size_t bucket)
+    {
+        points.resize(input.columns.size());
+        for (size_t c = 0; c < input.columns.size(); c++) {
+            points[c].clear();
+            for (size_t start = 0; start + bucket <= BATCH; start += bucket) {
+                float lo = std::numeric_limits<float>::infinity(), hi = -lo;
+                for (size_t i = start; i < start + bucket; i++) {
+                    if (input.y[c][i] < lo)
+                        lo = input.y[c][i];
+                    if (input.y[c][i] > hi)
+                        hi = input.y[c][i];
+                }
+                points[c].push_back(lo);
+                points[c].push_back(hi);
+            }
+        }
+    }
+    float checksum() const { return points[0].empty() ? 0.0f : points[0][0]; }
+};
+
+struct Kernel {
+    MinMaxDecimator decimator;
+
+    void run(const Input &input, size_t bucket)
+    {
+        if (decimator.bucketSize() != bucket || decimator.channels() != int(input.columns.size()))
+            decimator.reset(int(input.columns.size()), bucket);
+        decimator.clearPoints();
+        decimator.add(input.t.data(), input.y.data(), BATCH);
+    }
+    float checksum() const { return decimator.pointCount() ? decimator.values(0)[0] : 0.0f; }
+};
+
+template<typename Decimator>
+double run(const Input &input, size_t bucket, double seconds)
+{
+    Decimator decimator;
+    double checksum = 0.0;
+    size_t total = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds) {
+        decimator.run(input, bucket);
+        checksum += decimator.checksum();
+        total += BATCH;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (std::isnan(checksum))
+        std::fprintf(stderr, "NaN in output\n");
+    return double(total) * double(input.columns.size()) / elapsed;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    checkOrder();
+    std::printf("extreme order: %s\n", g_failures == 0 ? "ok" : "FAILED");
+
+    std::printf("Channel values/s on one core (M/s)\n");
+    std::printf("%-10s %-8s %14s %14s %14s\n", "channels", "bucket", "stride pick", "scalar minmax", "kernel");
+    for (int channels : {4, 32}) {
+        const Input input(channels);
+        for (size_t bucket : {size_t(6667), size_t(64)}) {
+            std::printf("%-10d %-8zu %14.1f %14.1f %14.1f\n", channels, bucket,
+                        run<StridePick>(input, bucket, seconds) / 1e6, run<ScalarMinMax>(input, bucket, seconds) / 1e6,
+                        run<Kernel>(input, bucket, seconds) / 1e6);
+        }
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// MpscQueue contention: 2, 4 and 8 producer threads feeding one consumer, with
+// single-element pushes and with batches. A mutex-guarded ring of the same size
+// is the baseline. Producers and the consumer yield when the queue is full or
+// empty, so oversubscribed machines still make progress.
+//
+//   mpscqueue_bench [operations per producer] [batch size]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MpscQueue.h"
+
+namespace {
+
+const size_t QUEUE_SIZE = 16384;
+
+// The obvious alternative: one ring, one lock
+class LockedQueue
+{
+public:
+    size_t push_batch(const long long *items, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t n = std::min(count, QUEUE_SIZE - (m_head - m_tail));
+        for (size_t i = 0; i < n; i++)
+            m_buffer[(m_head + i) & (QUEUE_SIZE - 1)] = items[i];
+        m_head += n;
+        return n;
+    }
+
+    size_t pop_batch(long long *items, size_t max_count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t n = std::min(max_count, m_head - m_tail);
+        for (size_t i = 0; i < n; i++)
+            items[i] = m_buffer[(m_tail + i) & (QUEUE_SIZE - 1)];
+        m_tail += n;
+        return n;
+    }
+
+private:
+    std::mutex m_mutex;
+    size_t m_head = 0;
+    size_t m_tail = 0;
+    long long m_buffer[QUEUE_SIZE];
+};
+
+template<typename Queue>
+double run(int producers, long long perProducer, size_t batch)
+{
+    auto *queue = new Queue;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            std::vector<long long> items(batch);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (long long i = 0; i < perProducer;) {
+                const size_t want = size_t(std::min<long long>(batch, perProducer - i));
+                for (size_t k = 0; k < want; k++)
+                    items[k] = i + static_cast<long long>(k) + p;
+                size_t done = 0;
+                while (done < want) {
+                    const size_t n = queue->push_batch(items.data() + done, want - done);
+                    if (n == 0)
+                        std::this_thread::yield();
+                    done += n;
+                }
+                i += static_cast<long long>(want);
+            }
+        });
+    }
+
+    const long long total = perProducer * producers;
+    std::vector<long long> items(256);
+    long long received = 0;
+    long long checksum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    while (received < total) {
+        const size_t n = queue->pop_batch(items.data(), items.size());
+        if (n == 0)
+            std::this_thread::yield();
+        for (size_t i = 0; i < n; i++)
+            checksum += items[i];
+        received += static_cast<long long>(n);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (std::thread &thread : threads)
+        thread.join();
+    delete queue;
+
+    long long expected = 0;
+    for (int p = 0; p < producers; p++)
+        expected += perProducer * (perProducer - 1) / 2 + perProducer * p;
+    if (checksum != expected) {
+        std::fprintf(stderr, "checksum mismatch\n");
+        std::exit(1);
+    }
+    return double(total) / seconds;
+}
+
+template<typename Queue>
+double median(int producers, long long perProducer, size_t batch)
+{
+    static const int RUNS = 3;
+    std::vector<double> rates;
+    for (int i = 0; i < RUNS; i++)
+        rates.push_back(run<Queue>(producers, perProducer, batch));
+    std::sort(rates.begin(), rates.end());
+    return rates[RUNS / 2];
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const long long perProducer = argc > 1 ? std::atoll(argv[1]) : 2000000LL;
+    const size_t batch = argc > 2 ? size_t(std::max(1, std::atoi(argv[2]))) : 32;
+
+    std::printf("%lld ops per producer, %u hardware threads, median of 3 (Mops/s)\n",
+                perProducer, std::thread::hardware_concurrency());
+    std::printf("%-10s %14s %14s %14s %14s\n", "producers", "mpsc x1", "locked x1", "mpsc batch", "locked batch");
+
+    for (int producers : {2, 4, 8}) {
+        const double single = median<MpscQueue<long long, QUEUE_SIZE>>(producers, perProducer, 1);
+        const double lockedSingle = median<LockedQueue>(producers, perProducer, 1);
+        const double batched = median<MpscQueue<long long, QUEUE_SIZE>>(producers, perProducer, batch);
+        const double lockedBatched = median<LockedQueue>(producers, perProducer, batch);
+        std::printf("%-10d %14.1f %14.1f %14.1f %14.1f\n", producers,
+                    single / 1e6, lockedSingle / 1e6, batched / 1e6, lockedBatched / 1e6);
+    }
+    return 0;
+}
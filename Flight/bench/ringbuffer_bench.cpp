@@ -0,0 +1,196 @@
+// SPSC RingBuffer throughput: one producer and one consumer thread, pinned to
+// two different cores when possible. Compares the current RingBuffer with the
+// previous layout (indices adjacent after the storage, no cached indices).
+//
+//   ringbuffer_bench [operations] [producer cpu] [consumer cpu]
+//
+// The two-thread case is only reported when both CPUs are distinct and in the
+// process's affinity mask; on a single CPU it would measure the scheduler.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "RingBuffer.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Keeps the single-thread loop's result alive without a branch on its value
+volatile long long g_sink;
+
+// The layout RingBuffer had before the cache-line split
+template<typename T, size_t Size>
+class AdjacentIndexRing
+{
+public:
+    bool push(const T &item) noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t next_head = (head + 1) & (Size - 1);
+        if (next_head == m_tail.load(std::memory_order_acquire))
+            return false;
+        m_buffer[head] = item;
+        m_head.store(next_head, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+        item = m_buffer[tail];
+        m_tail.store((tail + 1) & (Size - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Size> m_buffer;
+    std::atomic<size_t> m_head{0};
+    std::atomic<size_t> m_tail{0};
+};
+
+// Both cpus exist, differ and may be used by this process
+bool twoCoresAvailable(int producerCpu, int consumerCpu)
+{
+    if (producerCpu < 0 || consumerCpu < 0 || producerCpu == consumerCpu)
+        return false;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        return false;
+    return producerCpu < CPU_SETSIZE && consumerCpu < CPU_SETSIZE
+        && CPU_ISSET(producerCpu, &set) && CPU_ISSET(consumerCpu, &set);
+#else
+    return int(std::thread::hardware_concurrency()) > std::max(producerCpu, consumerCpu);
+#endif
+}
+
+void pinToCpu(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+template<typename Ring>
+double run(long long operations, int producerCpu, int consumerCpu)
+{
+    auto *ring = new Ring;
+    std::atomic<bool> go{false};
+    long long checksum = 0;
+
+    std::thread consumer([&]() {
+        pinToCpu(consumerCpu);
+        while (!go.load(std::memory_order_acquire))
+            ;
+        long long value;
+        for (long long i = 0; i < operations; i++) {
+            while (!ring->pop(value))
+                ;
+            checksum += value;
+        }
+    });
+
+    pinToCpu(producerCpu);
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (long long i = 0; i < operations; i++) {
+        while (!ring->push(i))
+            ;
+    }
+    consumer.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    delete ring;
+    if (checksum != operations * (operations - 1) / 2) {
+        std::fprintf(stderr, "checksum mismatch\n");
+        std::exit(1);
+    }
+    return double(operations) / seconds;
+}
+
+// Both sides on the calling thread in bursts: the per-operation cost without
+// any cross-core traffic, meaningful even on a single core
+template<typename Ring>
+double runBursts(long long operations, int, int)
+{
+    static const int BURST = 1024;
+    auto *ring = new Ring;
+    long long checksum = 0;
+    long long value = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < operations; i += BURST) {
+        for (long long j = i; j < i + BURST; j++)
+            ring->push(j);
+        for (int j = 0; j < BURST; j++) {
+            ring->pop(value);
+            checksum += value;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    delete ring;
+    g_sink = checksum;
+    return double(operations) / seconds;
+}
+
+template<typename Ring, double (*Run)(long long, int, int) = run<Ring>>
+double best(const char *name, long long operations, int producerCpu, int consumerCpu)
+{
+    static const int RUNS = 5;
+    std::vector<double> rates;
+    for (int i = 0; i < RUNS; i++)
+        rates.push_back(Run(operations, producerCpu, consumerCpu));
+    std::sort(rates.begin(), rates.end());
+    std::printf("%-28s median %8.1f Mops/s   best %8.1f Mops/s\n", name, rates[RUNS / 2] / 1e6, rates.back() / 1e6);
+    return rates[RUNS / 2];
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const long long operations = argc > 1 ? std::atoll(argv[1]) : 20000000LL;
+    const int producerCpu = argc > 2 ? std::atoi(argv[2]) : 0;
+    const int consumerCpu = argc > 3 ? std::atoi(argv[3]) : 1;
+
+    std::printf("%lld ops, producer cpu %d, consumer cpu %d, %u hardware threads\n",
+                operations, producerCpu, consumerCpu, std::thread::hardware_concurrency());
+
+    if (twoCoresAvailable(producerCpu, consumerCpu)) {
+        std::printf("two threads on cpus %d and %d:\n", producerCpu, consumerCpu);
+        const double before = best<AdjacentIndexRing<long long, 16384>>("adjacent indices", operations, producerCpu, consumerCpu);
+        const double after = best<RingBuffer<long long, 16384>>("RingBuffer (padded, cached)", operations, producerCpu, consumerCpu);
+        std::printf("speedup %.2fx\n\n", after / before);
+    } else {
+        std::printf("two threads: not measured, cpus %d and %d are not two distinct usable cpus\n\n", producerCpu, consumerCpu);
+    }
+
+    std::printf("single thread, bursts of 1024:\n");
+
+    const double burstBefore = best<AdjacentIndexRing<long long, 16384>, runBursts<AdjacentIndexRing<long long, 16384>>>(
+        "adjacent indices", operations, producerCpu, consumerCpu);
+    const double burstAfter = best<RingBuffer<long long, 16384>, runBursts<RingBuffer<long long, 16384>>>(
+        "RingBuffer (padded, cached)", operations, producerCpu, consumerCpu);
+    std::printf("speedup %.2fx\n", burstAfter / burstBefore);
+    return 0;
+}
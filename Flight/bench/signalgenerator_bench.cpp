@@ -0,0 +1,131 @@
+// SignalGenerator throughput on one core, against the loop SineWaveWorker used
+// before: std::sin per channel and sample, noise from std::normal_distribution
+// over mt19937. 4 and 32 channels, with and without noise, in millions of
+// channel values per second: flat across widths means a channel costs the same
+// however many others there are. Then the kernel alone for every waveform.
+//
+//   signalgenerator_bench [seconds per case]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "signalgenerator.h"
+
+namespace {
+
+const size_t BATCH = 4096;
+
+// The previous generator, one sample at a time
+class ReferenceGenerator
+{
+public:
+    explicit ReferenceGenerator(const GeneratorParams &params) : m_params(params), m_counter(0), m_rng(1), m_noise(0.0, 1.0) {}
+
+    void generate(double *t, float *const *y, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            t[i] = double(m_counter++) / m_params.sampleRate;
+            for (int ch = 0; ch < m_params.channelCount(); ch++) {
+                const ChannelParams &channel = m_params.channels[size_t(ch)];
+                const double phaseRad = channel.phase * M_PI / 180.0;
+                const double sine = channel.amplitude * std::sin(2.0 * M_PI * channel.frequency * t[i] + phaseRad);
+                const double noise = channel.noiseLevel * m_noise(m_rng);
+                y[ch][i] = float(channel.dc + sine + noise);
+            }
+        }
+    }
+
+private:
+    GeneratorParams m_params;
+    uint64_t m_counter;
+    std::mt19937 m_rng;
+    std::normal_distribution<double> m_noise;
+};
+
+class KernelGenerator
+{
+public:
+    explicit KernelGenerator(const GeneratorParams &params) : m_generator(1)
+    {
+        m_generator.setParams(params);
+    }
+
+    void generate(double *t, float *const *y, size_t count)
+    {
+        m_generator.generate(t, y, count);
+    }
+
+private:
+    SignalGenerator m_generator;
+};
+
+template<typename Generator>
+double run(const GeneratorParams &params, double seconds)
+{
+    Generator generator(params);
+    std::vector<double> t(BATCH);
+    std::vector<std::vector<float>> columns(params.channels.size(), std::vector<float>(BATCH));
+    std::vector<float *> y;
+    for (std::vector<float> &column : columns)
+        y.push_back(column.data());
+    double checksum = 0.0;
+    size_t total = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds) {
+        generator.generate(t.data(), y.data(), BATCH);
+        checksum += y[0][BATCH - 1];
+        total += BATCH;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (std::isnan(checksum))
+        std::fprintf(stderr, "NaN in output\n");
+    return double(total) * double(params.channels.size()) / elapsed;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    std::printf("Channel values/s on one core (M/s)\n");
+    std::printf("%-10s %-10s %14s %14s\n", "channels", "", "reference", "kernel");
+    for (int channels : {4, 32}) {
+        GeneratorParams noisy(channels);
+        noisy.sampleRate = 1e6;
+        GeneratorParams clean = noisy;
+        for (ChannelParams &channel : clean.channels)
+            channel.noiseLevel = 0.0;
+
+        std::printf("%-10d %-10s %14.1f %14.1f\n", channels, "noise", run<ReferenceGenerator>(noisy, seconds) / 1e6,
+                    run<KernelGenerator>(noisy, seconds) / 1e6);
+        std::printf("%-10d %-10s %14.1f %14.1f\n", channels, "no noise", run<ReferenceGenerator>(clean, seconds) / 1e6,
+                    run<KernelGenerator>(clean, seconds) / 1e6);
+    }
+
+    const char *waveforms[] = {"sine", "square", "triangle", "chirp", "step", "impulse", "prbs", "burst"};
+    std::printf("\n%-10s %14s %14s\n", "4 channels", "noise", "no noise");
+    for (int waveform = ChannelParams::Sine; waveform <= ChannelParams::Burst; waveform++) {
+        GeneratorParams noisy(4);
+        noisy.sampleRate = 1e6;
+        for (ChannelParams &channel : noisy.channels) {
+            channel.waveform = ChannelParams::Waveform(waveform);
+            channel.frequency *= 1000.0;
+            channel.sweepTime = 0.01;
+            channel.burstPeriod = 0.01;
+        }
+        GeneratorParams clean = noisy;
+        for (ChannelParams &channel : clean.channels)
+            channel.noiseLevel = 0.0;
+
+        std::printf("%-10s %14.1f %14.1f\n", waveforms[waveform], run<KernelGenerator>(noisy, seconds) / 1e6,
+                    run<KernelGenerator>(clean, seconds) / 1e6);
+    }
+    return 0;
+}
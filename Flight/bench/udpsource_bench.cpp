@@ -0,0 +1,104 @@
+// UdpSource loopback: a sender thread pushes small telemetry frames at the
+// source with sendmmsg(), batched like a board would, and the source's
+// recvmmsg() path decodes them. Prints datagrams received, frames decoded and
+// checksum errors, and fails if any frame is lost or damaged. The rate is the
+// paced sender's, not the receiver's limit.
+//
+//   udpsource_bench [frames] [port]
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "framedecoder.h"
+#include "udpsource.h"
+
+namespace {
+
+const int SEND_BATCH = 64;
+const int PAUSE_EVERY_BATCHES = 8;  // Keeps loopback from overrunning the socket buffer
+const int PAUSE_US = 50;
+
+struct CountingSink : public SourceSink {
+    FrameDecoder decoder;
+    quint64 frames = 0;
+
+    CountingSink()
+    {
+        decoder.setFrameHandler([this](const DecodedFrame &) { frames++; });
+    }
+    void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) override
+    {
+        decoder.feed(data, length, timestampNs);
+    }
+};
+
+void send(quint16 port, int frames)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+
+    // One ADC frame: start, length, command, value (big-endian), checksum
+    unsigned char frame[6] = {0x8A, 7, 2, 0x01, 0x23, 0};
+    frame[5] = static_cast<unsigned char>(0x8A + 7 + 2 + 0x01 + 0x23);
+    mmsghdr messages[SEND_BATCH];
+    iovec vectors[SEND_BATCH];
+    for (int i = 0; i < SEND_BATCH; i++) {
+        vectors[i].iov_base = frame;
+        vectors[i].iov_len = sizeof(frame);
+        std::memset(&messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for (int sent = 0, batches = 0; sent < frames; batches++) {
+        const int n = sendmmsg(fd, messages, unsigned(std::min(SEND_BATCH, frames - sent)), 0);
+        if (n > 0)
+            sent += n;
+        if (batches % PAUSE_EVERY_BATCHES == 0)
+            usleep(PAUSE_US);
+    }
+    close(fd);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const quint16 port = quint16(argc > 2 ? std::atoi(argv[2]) : 15550);
+
+    UdpSource source(port);
+    if (!source.open()) {
+        std::fprintf(stderr, "Cannot bind UDP port %u\n", unsigned(port));
+        return 1;
+    }
+
+    CountingSink sink;
+    std::atomic<bool> done(false);
+    std::thread sender([&]() {
+        send(port, frames);
+        done.store(true);
+    });
+
+    const qint64 startNs = HostClock::nowNs();
+    while (!done.load() || source.poll(sink, 50) > 0)
+        source.poll(sink, 10);
+    const qint64 elapsedNs = HostClock::nowNs() - startNs;
+    sender.join();
+
+    std::printf("%llu datagrams, %llu frames, %llu checksum errors, %.0f datagrams/s\n",
+                static_cast<unsigned long long>(source.datagramsReceived()),
+                static_cast<unsigned long long>(sink.frames),
+                static_cast<unsigned long long>(sink.decoder.checksumErrors()),
+                double(source.datagramsReceived()) * 1e9 / double(elapsedNs));
+    return sink.frames == quint64(frames) && sink.decoder.checksumErrors() == 0 ? 0 : 1;
+}
@@ -10,13 +10,15 @@ QT_USE_NAMESPACE
 Q_DECLARE_METATYPE(QAbstractSeries *)
     Q_DECLARE_METATYPE(QAbstractAxis *)
 
-DataSource::DataSource(QQueue<QPointF> *samplesQueue, QObject *parent) : QObject(parent)
+DataSource::DataSource(SamplerWorker::SampleRing *samples, QObject *parent) : QObject(parent)
 {
     //m_index = -1;
     qRegisterMetaType<QAbstractSeries*>();
     qRegisterMetaType<QAbstractAxis*>();
 
-    m_SamplesQueue = samplesQueue;
+    m_samples = samples;
+    m_scratch.resize(1024);
+    m_newPoints.reserve(PLOT_HISTORY_POINTS);
 }
 
 DataSource::~DataSource()
@@ -28,10 +30,35 @@ DataSource::~DataSource()
 
 void DataSource::update(QAbstractSeries *series)
 {
-    if(series)
+    if(!series)
+        return;
+
+    // Only the points produced since the last update cross the thread boundary
+    size_t count;
+    while((count = m_samples->pop_batch(m_scratch.data(), m_scratch.size())) > 0)
+    {
+        for(size_t i = 0; i < count; i++)
+            m_newPoints.append(m_scratch[i]);
+    }
+    if(m_newPoints.isEmpty())
+        return;
+
+    // Older points than the visible history are never drawn
+    if(m_newPoints.size() > PLOT_HISTORY_POINTS)
+        m_newPoints.remove(0, m_newPoints.size() - PLOT_HISTORY_POINTS);
+
+    QXYSeries *xySeries = static_cast<QXYSeries *>(series);
+    const int excess = xySeries->count() + int(m_newPoints.size()) - PLOT_HISTORY_POINTS;
+    if(excess >= xySeries->count())
+    {
+        xySeries->replace(m_newPoints);
+    }
+    else
     {
-        QXYSeries *xySeries = static_cast<QXYSeries *>(series);
-        xySeries->replace(*m_SamplesQueue);
+        if(excess > 0)
+            xySeries->removePoints(0, excess);
+        xySeries->append(m_newPoints);
     }
+    m_newPoints.clear();
 }
 
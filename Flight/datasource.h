@@ -2,8 +2,13 @@
 #define DATASOURCE_H
 
 #include <QObject>
-#include <QQueue>
+#include <QList>
+#include <QPointF>
 #include <QFile>
+#include <vector>
+#include "samplerworker.h"
+
+#define PLOT_HISTORY_POINTS     2100
 
 QT_BEGIN_NAMESPACE
 class QAbstractSeries;
@@ -13,11 +18,18 @@ QT_USE_NAMESPACE
 
 
 
+/**
+ * @brief GUI-side consumer of the sampler's point ring
+ *
+ * update() drains whatever the worker produced since the last call and appends
+ * only those points to the series, trimming it to PLOT_HISTORY_POINTS, so the
+ * series itself is the history and nothing is copied wholesale per update.
+ */
 class DataSource : public QObject
 {
     Q_OBJECT
 public:
-    explicit DataSource(QQueue<QPointF> *samplesQueue, QObject *parent = nullptr);
+    explicit DataSource(SamplerWorker::SampleRing *samples, QObject *parent = nullptr);
     ~DataSource();
 signals:
     void updateCurve();
@@ -26,7 +38,9 @@ public slots:
     void update(QAbstractSeries *series);
     //void timerTrigger();
 private:
-    QQueue<QPointF> *m_SamplesQueue;
+    SamplerWorker::SampleRing *m_samples;
+    std::vector<QPointF> m_scratch;
+    QList<QPointF> m_newPoints;
     //int m_index;
 };
 
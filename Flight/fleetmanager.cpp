@@ -0,0 +1,389 @@
+#include "fleetmanager.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <QVariantMap>
+#include <QtCharts/QXYSeries>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include "RingBuffer.h"
+#include "framedecoder.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+QT_USE_NAMESPACE
+
+struct FleetChunk {
+    qint64 timestampNs;
+    int length;
+    quint8 data[FleetManager::CHUNK_SIZE];
+};
+
+struct FleetManager::Board : public SourceSink {
+    FleetManager *manager = nullptr;
+    QString name;
+    int ioThread = 0;
+    int homeQueue = 0;
+    TelemetrySource *source = nullptr;
+
+    // Producer: the board's I/O thread. Consumer: whichever worker holds 'scheduled'
+    RingBuffer<FleetChunk, CHUNK_RING_SIZE> chunks;
+    // Producer: the decoding worker. Consumer: drainSamples() on the GUI thread
+    RingBuffer<TelemetrySample, SAMPLE_RING_SIZE> samples;
+    FrameDecoder decoder;
+    std::atomic<bool> scheduled{false};
+
+    std::atomic<bool> open{false};
+    std::atomic<quint64> bytesReceived{0};
+    std::atomic<quint64> chunksReceived{0};
+    std::atomic<quint64> framesDecoded{0};
+    std::atomic<quint64> checksumErrors{0};
+    std::atomic<quint64> droppedChunks{0};
+    std::atomic<quint64> droppedSamples{0};
+    std::atomic<quint64> samplesDelivered{0};
+    std::atomic<qint64> lastActivityNs{0};
+
+    ~Board() override { delete source; }
+
+    void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) override
+    {
+        FleetChunk chunk;
+        chunk.timestampNs = timestampNs;
+        bytesReceived.fetch_add(quint64(length), std::memory_order_relaxed);
+        while (length > 0) {
+            chunk.length = int(std::min(length, qint64(CHUNK_SIZE)));
+            memcpy(chunk.data, data, size_t(chunk.length));
+            if (!chunks.push(chunk))
+                droppedChunks.fetch_add(1, std::memory_order_relaxed);
+            data += chunk.length;
+            length -= chunk.length;
+            chunksReceived.fetch_add(1, std::memory_order_relaxed);
+        }
+        lastActivityNs.store(timestampNs, std::memory_order_relaxed);
+    }
+};
+
+struct FleetManager::DecodeQueue {
+    std::mutex mutex;
+    std::deque<Board *> boards;
+};
+
+FleetManager::FleetManager(int ioThreads, int decodeThreads, QObject *parent) :
+    QObject(parent),
+    m_ioThreadCount(std::max(1, ioThreads)),
+    m_decodeThreadCount(decodeThreads),
+    m_running(false),
+    m_drainTimer(new QTimer(this)),
+    m_startNs(0)
+{
+    if (m_decodeThreadCount <= 0)
+        m_decodeThreadCount = std::max(1, QThread::idealThreadCount() - m_ioThreadCount);
+
+    for (int i = 0; i < m_decodeThreadCount; i++)
+        m_queues.emplace_back(new DecodeQueue);
+
+    m_scratch.resize(SAMPLE_RING_SIZE);
+    m_drainTimer->setInterval(DRAIN_INTERVAL_MS);
+    connect(m_drainTimer, &QTimer::timeout, this, &FleetManager::drainSamples);
+}
+
+FleetManager::~FleetManager()
+{
+    stop();
+}
+
+int FleetManager::addVehicle(const QString &name, TelemetrySource *source)
+{
+    if (isRunning() || !source) {
+        delete source;
+        return -1;
+    }
+
+    const int index = int(m_boards.size());
+    Board *board = new Board;
+    board->manager = this;
+    board->name = name;
+    board->source = source;
+    board->ioThread = index % m_ioThreadCount;
+    board->homeQueue = index % m_decodeThreadCount;
+    board->decoder.setFrameHandler([board](const DecodedFrame &frame) {
+        TelemetrySample sample;
+        sample.timestampNs = frame.timestampNs;
+        sample.channel = frame.cmd;
+        sample.link = 0;
+        sample.value = float(frame.value());
+        if (!board->samples.push(sample))
+            board->droppedSamples.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    m_boards.emplace_back(board);
+    return index;
+}
+
+void FleetManager::start()
+{
+#ifdef Q_OS_LINUX
+    if (isRunning())
+        return;
+    m_running.store(true, std::memory_order_release);
+    m_startNs = HostClock::nowNs();
+    m_history.clear();
+
+    for (int i = 0; i < m_ioThreadCount; i++)
+        m_threads.append(QThread::create([this, i]() { ioLoop(i); }));
+    for (int i = 0; i < m_decodeThreadCount; i++)
+        m_threads.append(QThread::create([this, i]() { decodeLoop(i); }));
+    for (QThread *thread : m_threads)
+        thread->start();
+
+    m_drainTimer->start();
+    qDebug() << "FleetManager: Started" << m_boards.size() << "boards on" << m_ioThreadCount
+             << "I/O and" << m_decodeThreadCount << "decode threads";
+#else
+    qWarning() << "FleetManager: Fleet mode requires epoll (Linux)";
+#endif
+}
+
+void FleetManager::stop()
+{
+    if (!isRunning())
+        return;
+
+    m_drainTimer->stop();
+    m_running.store(false, std::memory_order_release);
+    m_idleCondition.notify_all();
+
+    for (QThread *thread : m_threads) {
+        thread->wait();
+        delete thread;
+    }
+    m_threads.clear();
+    drainSamples();
+
+    qDebug() << "FleetManager: Stopped";
+}
+
+void FleetManager::ioLoop(int index)
+{
+#ifdef Q_OS_LINUX
+    static const int MAX_EVENTS = 64;
+    static const qint64 REOPEN_INTERVAL_NS = 1000000000LL;
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        qWarning() << "FleetManager: epoll_create1 failed:" << strerror(errno);
+        return;
+    }
+
+    // Sources are opened here so that they live in the thread that reads them
+    std::vector<Board *> mine;
+    for (const auto &board : m_boards) {
+        if (board->ioThread == index)
+            mine.push_back(board.get());
+    }
+
+    qint64 nextOpenNs = 0;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (m_running.load(std::memory_order_acquire)) {
+        const qint64 nowNs = HostClock::nowNs();
+        if (nowNs >= nextOpenNs) {
+            for (Board *board : mine) {
+                if (board->open.load(std::memory_order_relaxed) || !board->source->open())
+                    continue;
+                struct epoll_event ev;
+                ev.events = EPOLLIN;
+                ev.data.ptr = board;
+                if (board->source->handle() < 0
+                    || epoll_ctl(epfd, EPOLL_CTL_ADD, board->source->handle(), &ev) < 0) {
+                    qWarning() << "FleetManager:" << board->name << "has no pollable handle";
+                    board->source->close();
+                    continue;
+                }
+                board->open.store(true, std::memory_order_relaxed);
+            }
+            nextOpenNs = nowNs + REOPEN_INTERVAL_NS;
+        }
+
+        int n = epoll_wait(epfd, events, MAX_EVENTS, 100);
+        for (int i = 0; i < n; i++) {
+            Board *board = static_cast<Board *>(events[i].data.ptr);
+            const qint64 received = board->source->poll(*board, 0);
+            if (received > 0) {
+                schedule(board);
+            } else if (received < 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                qWarning() << "FleetManager:" << board->name << "lost its source, reopening";
+                epoll_ctl(epfd, EPOLL_CTL_DEL, board->source->handle(), nullptr);
+                board->source->close();
+                board->open.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    for (Board *board : mine) {
+        board->source->close();
+        board->open.store(false, std::memory_order_relaxed);
+    }
+    ::close(epfd);
+#else
+    Q_UNUSED(index);
+#endif
+}
+
+void FleetManager::schedule(Board *board)
+{
+    // A board is in at most one queue, so only one worker ever decodes it
+    if (board->scheduled.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    DecodeQueue *queue = m_queues[size_t(board->homeQueue)].get();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->boards.push_back(board);
+    }
+    m_idleCondition.notify_one();
+}
+
+FleetManager::Board *FleetManager::takeWork(int index)
+{
+    // Own queue in FIFO order keeps boards round-robin fair
+    {
+        DecodeQueue *own = m_queues[size_t(index)].get();
+        std::lock_guard<std::mutex> lock(own->mutex);
+        if (!own->boards.empty()) {
+            Board *board = own->boards.front();
+            own->boards.pop_front();
+            return board;
+        }
+    }
+
+    // Steal from the back of the other workers' queues
+    const int count = int(m_queues.size());
+    for (int i = 1; i < count; i++) {
+        DecodeQueue *victim = m_queues[size_t((index + i) % count)].get();
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->boards.empty()) {
+            Board *board = victim->boards.back();
+            victim->boards.pop_back();
+            return board;
+        }
+    }
+    return nullptr;
+}
+
+void FleetManager::runQuantum(Board *board, int worker)
+{
+    FleetChunk chunk;
+    for (int i = 0; i < DECODE_QUANTUM && board->chunks.pop(chunk); i++)
+        board->decoder.feed(chunk.data, chunk.length, chunk.timestampNs);
+
+    board->framesDecoded.store(board->decoder.framesDecoded(), std::memory_order_relaxed);
+    board->checksumErrors.store(board->decoder.checksumErrors(), std::memory_order_relaxed);
+
+    if (!board->chunks.empty()) {
+        // Still busy: back of the queue, behind every other ready board
+        DecodeQueue *queue = m_queues[size_t(worker)].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->boards.push_back(board);
+        return;
+    }
+
+    board->scheduled.store(false, std::memory_order_release);
+    // A chunk may have landed between the last pop and the release above
+    if (!board->chunks.empty())
+        schedule(board);
+}
+
+void FleetManager::decodeLoop(int index)
+{
+    while (m_running.load(std::memory_order_acquire)) {
+        Board *board = takeWork(index);
+        if (!board) {
+            std::unique_lock<std::mutex> lock(m_idleMutex);
+            m_idleCondition.wait_for(lock, std::chrono::milliseconds(10));
+            continue;
+        }
+        runQuantum(board, index);
+    }
+}
+
+void FleetManager::drainSamples()
+{
+    bool delivered = false;
+    for (size_t vehicle = 0; vehicle < m_boards.size(); vehicle++) {
+        Board *board = m_boards[vehicle].get();
+        size_t count;
+        while ((count = board->samples.pop_batch(m_scratch.data(), m_scratch.size())) > 0) {
+            for (size_t i = 0; i < count; i++)
+                appendPoint(int(vehicle), m_scratch[i]);
+            board->samplesDelivered.fetch_add(count, std::memory_order_relaxed);
+            delivered = true;
+        }
+    }
+    if (delivered)
+        emit updateCurve();
+    emit healthChanged();
+}
+
+void FleetManager::appendPoint(int vehicle, const TelemetrySample &sample)
+{
+    QList<QPointF> &history = m_history[channelKey(vehicle, sample.channel)];
+    if (history.size() >= HISTORY_POINTS)
+        history.removeFirst();
+    history.append(QPointF(qreal(sample.timestampNs - m_startNs) / 1e9, qreal(sample.value)));
+}
+
+void FleetManager::update(QAbstractSeries *series, int vehicle, int channel)
+{
+    if (series) {
+        QXYSeries *xySeries = static_cast<QXYSeries *>(series);
+        xySeries->replace(m_history.value(channelKey(vehicle, channel)));
+    }
+}
+
+FleetHealth FleetManager::health(int vehicle) const
+{
+    FleetHealth health;
+    if (vehicle < 0 || vehicle >= vehicleCount())
+        return health;
+
+    const Board *board = m_boards[size_t(vehicle)].get();
+    health.name = board->name;
+    health.open = board->open.load(std::memory_order_relaxed);
+    health.bytesReceived = board->bytesReceived.load(std::memory_order_relaxed);
+    health.chunksReceived = board->chunksReceived.load(std::memory_order_relaxed);
+    health.framesDecoded = board->framesDecoded.load(std::memory_order_relaxed);
+    health.checksumErrors = board->checksumErrors.load(std::memory_order_relaxed);
+    health.droppedChunks = board->droppedChunks.load(std::memory_order_relaxed);
+    health.droppedSamples = board->droppedSamples.load(std::memory_order_relaxed);
+    health.samplesDelivered = board->samplesDelivered.load(std::memory_order_relaxed);
+    health.lastActivityNs = board->lastActivityNs.load(std::memory_order_relaxed);
+    return health;
+}
+
+QVariantList FleetManager::healthReport() const
+{
+    const qint64 nowNs = HostClock::nowNs();
+    QVariantList report;
+    for (int i = 0; i < vehicleCount(); i++) {
+        const FleetHealth h = health(i);
+        QVariantMap entry;
+        entry["name"] = h.name;
+        entry["open"] = h.open;
+        entry["bytesReceived"] = h.bytesReceived;
+        entry["framesDecoded"] = h.framesDecoded;
+        entry["checksumErrors"] = h.checksumErrors;
+        entry["droppedChunks"] = h.droppedChunks;
+        entry["droppedSamples"] = h.droppedSamples;
+        entry["samplesDelivered"] = h.samplesDelivered;
+        entry["idleMs"] = h.lastActivityNs > 0 ? double(nowNs - h.lastActivityNs) / 1e6 : -1.0;
+        report.append(entry);
+    }
+    return report;
+}
@@ -0,0 +1,121 @@
+#ifndef FLEETMANAGER_H
+#define FLEETMANAGER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "telemetrysource.h"
+
+QT_BEGIN_NAMESPACE
+class QAbstractSeries;
+class QThread;
+class QTimer;
+QT_END_NAMESPACE
+
+/**
+ * @brief Per-board health counters, a consistent-enough snapshot for display
+ */
+struct FleetHealth {
+    QString name;
+    bool open = false;
+    quint64 bytesReceived = 0;
+    quint64 chunksReceived = 0;
+    quint64 framesDecoded = 0;
+    quint64 checksumErrors = 0;
+    quint64 droppedChunks = 0;     // Decode side fell behind this board
+    quint64 droppedSamples = 0;    // Consumer side fell behind this board
+    quint64 samplesDelivered = 0;
+    qint64 lastActivityNs = 0;     // HostClock time of the last received chunk
+};
+
+/**
+ * @brief Fleet mode: dozens of boards on a shared, fixed-size thread pool
+ *
+ * A few I/O threads each multiplex a share of the boards' file descriptors with
+ * epoll and copy received chunks into the board's own SPSC chunk ring. A ready
+ * board is scheduled once onto a decode worker; workers take from their own
+ * queue and steal from the others when idle. A board is decoded by one worker at
+ * a time for at most DECODE_QUANTUM chunks before going to the back of the
+ * queue, and all buffering is per board, so a noisy link only ever drops its own
+ * data and cannot starve the others.
+ *
+ * On the GUI thread the decoded samples of every board are kept as a per-channel
+ * history on a host-time axis (seconds since start()), which update() feeds to a
+ * chart series, as Vehicle does for its links.
+ *
+ * Linux only (epoll).
+ */
+class FleetManager : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int vehicleCount READ vehicleCount CONSTANT)
+public:
+    static const int CHUNK_SIZE = 2048;
+    static const size_t CHUNK_RING_SIZE = 128;
+    static const size_t SAMPLE_RING_SIZE = 8192;
+    static const int DECODE_QUANTUM = 32;       // Chunks per scheduling turn
+    static const int DRAIN_INTERVAL_MS = 50;
+    static const int HISTORY_POINTS = 2100;     // Per channel, as Vehicle keeps
+
+    explicit FleetManager(int ioThreads = 2, int decodeThreads = 0, QObject *parent = nullptr);
+    ~FleetManager();
+
+    // Takes ownership of source; only before start()
+    int addVehicle(const QString &name, TelemetrySource *source);
+    int vehicleCount() const { return int(m_boards.size()); }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    FleetHealth health(int vehicle) const;
+    Q_INVOKABLE QVariantList healthReport() const;
+
+    Q_INVOKABLE void update(QAbstractSeries *series, int vehicle, int channel);
+
+signals:
+    void healthChanged();
+    void updateCurve();
+
+private slots:
+    void drainSamples();
+
+private:
+    struct Board;
+    struct DecodeQueue;
+
+    void ioLoop(int index);
+    void decodeLoop(int index);
+    void schedule(Board *board);
+    Board *takeWork(int index);
+    void runQuantum(Board *board, int worker);
+
+    static quint32 channelKey(int vehicle, int channel) { return (quint32(vehicle) << 16) | quint32(channel & 0xFFFF); }
+    void appendPoint(int vehicle, const TelemetrySample &sample);
+
+    std::vector<std::unique_ptr<Board>> m_boards;
+    std::vector<std::unique_ptr<DecodeQueue>> m_queues;
+    QVector<QThread *> m_threads;
+    int m_ioThreadCount;
+    int m_decodeThreadCount;
+
+    std::atomic<bool> m_running;
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCondition;
+
+    QTimer *m_drainTimer;
+    qint64 m_startNs;
+    std::vector<TelemetrySample> m_scratch;
+    QHash<quint32, QList<QPointF>> m_history;
+};
+
+#endif // FLEETMANAGER_H
@@ -214,6 +214,24 @@ QByteArray Frame::GetBuffer()
     return m_buffer;
 }
 
+// Wire form: everything after the start byte has FRAME_START/FRAME_ESCAPE_CHAR escaped
+QByteArray Frame::GetEscapedBuffer()
+{
+    QByteArray rv;
+    rv.reserve(m_buffer.count() * 2);
+    for (int i = 0; i < m_buffer.count(); i++)
+    {
+        quint8 data = quint8(m_buffer[i]);
+        if (i != INDEX_START_OF_FRAME && (data == FRAME_START || data == FRAME_ESCAPE_CHAR))
+        {
+            rv.append(char(FRAME_ESCAPE_CHAR));
+            data ^= FRAME_XOR_CHAR;
+        }
+        rv.append(char(data));
+    }
+    return rv;
+}
+
 quint16 Frame::makeWord(quint8 l, quint8 h)
 {
     quint16 rv = h;
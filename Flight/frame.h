@@ -54,6 +54,7 @@ public:
     void    Clear();
     void    AddByte(quint8 data);
     QByteArray GetBuffer();
+    QByteArray GetEscapedBuffer();
 
 signals:
 
@@ -0,0 +1,96 @@
+#include "framedecoder.h"
+#include "frame.h"
+
+FrameDecoder::FrameDecoder()
+{
+    reset();
+    m_framesDecoded = 0;
+    m_checksumErrors = 0;
+}
+
+void FrameDecoder::setFrameHandler(FrameHandler handler)
+{
+    m_handler = std::move(handler);
+}
+
+void FrameDecoder::reset()
+{
+    m_receiverStatus = RCV_ST_IDLE;
+    m_xored = 0x00;
+    m_checksum = 0;
+    m_cmd = 0;
+    m_dataLength = 0;
+    m_numByte = 0;
+}
+
+void FrameDecoder::feed(const quint8 *data, qint64 length, qint64 timestampNs)
+{
+    for (qint64 i = 0; i < length; i++)
+    {
+        quint8 inByte = data[i];
+
+        if (inByte == Frame::FRAME_START)
+        {
+            m_receiverStatus = RCV_ST_CMD;
+            m_checksum = inByte;
+            m_xored = 0x00;
+            continue;
+        }
+
+        if (m_receiverStatus == RCV_ST_IDLE)
+            continue;
+
+        if (inByte == Frame::FRAME_ESCAPE_CHAR)
+        {
+            m_xored = Frame::FRAME_XOR_CHAR;
+            continue;
+        }
+
+        inByte ^= m_xored;
+        m_xored = 0x00;
+
+        switch (m_receiverStatus)
+        {
+        case RCV_ST_CMD:
+            m_cmd = inByte;
+            m_checksum += inByte;
+            m_receiverStatus = RCV_ST_DATA_LENGTH;
+            break;
+
+        case RCV_ST_DATA_LENGTH:
+            m_dataLength = inByte;
+            m_numByte = 0;
+            m_checksum += inByte;
+            m_receiverStatus = (m_dataLength > 0) ? RCV_ST_DATA : RCV_ST_CHECKSUM;
+            break;
+
+        case RCV_ST_DATA:
+            m_data[m_numByte++] = inByte;
+            m_checksum += inByte;
+            if (m_numByte >= m_dataLength)
+                m_receiverStatus = RCV_ST_CHECKSUM;
+            break;
+
+        case RCV_ST_CHECKSUM:
+            if (inByte == m_checksum)
+            {
+                m_framesDecoded++;
+                if (m_handler)
+                {
+                    DecodedFrame frame;
+                    frame.cmd = m_cmd;
+                    frame.length = quint8(m_dataLength);
+                    frame.data = m_data;
+                    frame.timestampNs = timestampNs;
+                    m_handler(frame);
+                }
+            }
+            else
+            {
+                m_checksumErrors++;
+            }
+            m_receiverStatus = RCV_ST_IDLE;
+            break;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <QtGlobal>
+#include <functional>
+
+/**
+ * @brief Payload of one complete, checksum-verified frame
+ *
+ * data points into the decoder's internal buffer and is only valid for the
+ * duration of the handler call.
+ */
+struct DecodedFrame {
+    quint8 cmd;
+    quint8 length;
+    const quint8 *data;
+    qint64 timestampNs;  // Arrival time of the chunk that completed the frame
+
+    // Payload as a big-endian unsigned integer (the layout Frame uses to encode)
+    quint32 value() const
+    {
+        quint32 rv = 0;
+        for (int i = 0; i < length && i < 4; i++)
+            rv = (rv << 8) | data[i];
+        return rv;
+    }
+};
+
+/**
+ * @brief Streaming decoder for the Frame wire format
+ *
+ * [FRAME_START][CMD][LENGTH][DATA...][CHECKSUM], with FRAME_START and
+ * FRAME_ESCAPE_CHAR inside the frame escaped as FRAME_ESCAPE_CHAR, byte ^ FRAME_XOR_CHAR.
+ * The checksum is the 8-bit sum of all unescaped bytes before it (see
+ * Frame::CalculateChecksum). A FRAME_START byte always resynchronises.
+ *
+ * The decoder never allocates while feeding, so it can sit on the hot path of
+ * every source.
+ */
+class FrameDecoder
+{
+public:
+    using FrameHandler = std::function<void(const DecodedFrame &)>;
+
+    FrameDecoder();
+
+    void setFrameHandler(FrameHandler handler);
+    void feed(const quint8 *data, qint64 length, qint64 timestampNs);
+    void reset();
+
+    quint64 framesDecoded() const { return m_framesDecoded; }
+    quint64 checksumErrors() const { return m_checksumErrors; }
+
+private:
+    static const int RCV_ST_IDLE = 0;
+    static const int RCV_ST_CMD = 1;
+    static const int RCV_ST_DATA_LENGTH = 2;
+    static const int RCV_ST_DATA = 3;
+    static const int RCV_ST_CHECKSUM = 4;
+
+    FrameHandler m_handler;
+    int m_receiverStatus;
+    quint8 m_xored;
+    quint8 m_checksum;
+    quint8 m_cmd;
+    int m_dataLength;
+    int m_numByte;
+    quint8 m_data[256];
+
+    quint64 m_framesDecoded;
+    quint64 m_checksumErrors;
+};
+
+#endif // FRAMEDECODER_H
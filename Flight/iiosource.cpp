@@ -0,0 +1,390 @@
+#include "iiosource.h"
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+bool IioChannel::parseType(const QString &type)
+{
+    // [be|le]:[s|u]bits/storagebits[Xrepeat][>>shift]
+    static const QRegularExpression re(QStringLiteral("^(be|le):([su])(\\d+)/(\\d+)(?:X\\d+)?>>(\\d+)$"));
+    QRegularExpressionMatch match = re.match(type.trimmed());
+    if (!match.hasMatch())
+        return false;
+
+    bigEndian = match.captured(1) == QLatin1String("be");
+    isSigned = match.captured(2) == QLatin1String("s");
+    realBits = match.captured(3).toInt();
+    storageBits = match.captured(4).toInt();
+    shift = match.captured(5).toInt();
+
+    return (storageBits == 8 || storageBits == 16 || storageBits == 32)
+           && realBits > 0 && realBits + shift <= storageBits;
+}
+
+void IioScanLayout::finalize()
+{
+    std::sort(channels.begin(), channels.end(),
+              [](const IioChannel &a, const IioChannel &b) { return a.index < b.index; });
+
+    int offset = 0;
+    int largest = 1;
+    for (IioChannel &channel : channels) {
+        const int bytes = channel.storageBits / 8;
+        offset = (offset + bytes - 1) / bytes * bytes;
+        channel.offset = offset;
+        offset += bytes;
+        largest = std::max(largest, bytes);
+    }
+
+    if (hasTimestamp) {
+        offset = (offset + 7) / 8 * 8;
+        timestampOffset = offset;
+        offset += 8;
+        largest = 8;
+    } else {
+        timestampOffset = -1;
+    }
+
+    scanBytes = (offset + largest - 1) / largest * largest;
+}
+
+bool IioScanLayout::isUniform16() const
+{
+    if (channels.isEmpty() || hasTimestamp || scanBytes != channels.size() * 2)
+        return false;
+
+    const IioChannel &first = channels.first();
+    for (const IioChannel &channel : channels) {
+        if (channel.storageBits != 16 || channel.bigEndian
+            || channel.isSigned != first.isSigned
+            || channel.realBits != first.realBits
+            || channel.shift != first.shift)
+            return false;
+    }
+    return true;
+}
+
+IioSource::IioSource(const QString &device, const QStringList &channels, double sampleRate) :
+    m_device(device),
+    m_channelNames(channels),
+    m_charDevice(QStringLiteral("/dev/") + device),
+    m_standIn(false),
+    m_sampleRate(sampleRate),
+    m_periodNs(0),
+    m_fd(-1),
+    m_pending(0),
+    m_scansRead(0)
+{
+}
+
+IioSource::IioSource(const QString &path, const IioScanLayout &layout, double sampleRate) :
+    m_charDevice(path),
+    m_standIn(true),
+    m_sampleRate(sampleRate),
+    m_periodNs(0),
+    m_layout(layout),
+    m_fd(-1),
+    m_pending(0),
+    m_scansRead(0)
+{
+    m_layout.finalize();
+}
+
+IioSource::~IioSource()
+{
+    close();
+}
+
+QString IioSource::sysfsPath(const QString &attribute) const
+{
+    return QStringLiteral("/sys/bus/iio/devices/") + m_device + QLatin1Char('/') + attribute;
+}
+
+bool IioSource::writeAttribute(const QString &path, const QByteArray &value)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    return file.write(value) == value.size();
+}
+
+QByteArray IioSource::readAttribute(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll().trimmed();
+}
+
+bool IioSource::configureDevice()
+{
+    // The buffer must be disabled while scan elements change
+    disableBuffer();
+
+    m_layout = IioScanLayout();
+    for (const QString &name : m_channelNames) {
+        IioChannel channel;
+        channel.name = name;
+        const QString element = QStringLiteral("scan_elements/in_") + name;
+
+        if (!writeAttribute(sysfsPath(element + QStringLiteral("_en")), "1")) {
+            qWarning() << "IioSource: Cannot enable scan element" << name;
+            return false;
+        }
+        bool ok = false;
+        channel.index = readAttribute(sysfsPath(element + QStringLiteral("_index"))).toInt(&ok);
+        if (!ok || !channel.parseType(QString::fromLatin1(readAttribute(sysfsPath(element + QStringLiteral("_type")))))) {
+            qWarning() << "IioSource: Unsupported scan element format for" << name;
+            return false;
+        }
+        m_layout.channels.append(channel);
+    }
+
+    // Put the timestamp on the host monotonic timeline when the driver offers one
+    if (writeAttribute(sysfsPath(QStringLiteral("scan_elements/in_timestamp_en")), "1")) {
+        m_layout.hasTimestamp = true;
+        if (!writeAttribute(sysfsPath(QStringLiteral("current_timestamp_clock")), "monotonic")) {
+            qWarning() << "IioSource: Cannot select monotonic timestamp clock, using arrival time";
+            writeAttribute(sysfsPath(QStringLiteral("scan_elements/in_timestamp_en")), "0");
+            m_layout.hasTimestamp = false;
+        }
+    }
+    m_layout.finalize();
+
+    if (m_sampleRate <= 0.0)
+        m_sampleRate = readAttribute(sysfsPath(QStringLiteral("sampling_frequency"))).toDouble();
+
+    writeAttribute(sysfsPath(QStringLiteral("buffer/length")), QByteArray::number(DEFAULT_BUFFER_LENGTH));
+    // Wake the reader once a block is ready rather than per scan
+    writeAttribute(sysfsPath(QStringLiteral("buffer/watermark")), QByteArray::number(BLOCK_SCANS / 4));
+
+    if (!writeAttribute(sysfsPath(QStringLiteral("buffer/enable")), "1")) {
+        qWarning() << "IioSource: Cannot enable buffer on" << m_device;
+        return false;
+    }
+    return true;
+}
+
+void IioSource::disableBuffer()
+{
+    if (!m_standIn)
+        writeAttribute(sysfsPath(QStringLiteral("buffer/enable")), "0");
+}
+
+bool IioSource::open()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0)
+        return true;
+
+    if (!m_standIn && !configureDevice()) {
+        disableBuffer();
+        return false;
+    }
+    if (m_layout.channels.isEmpty() || m_layout.scanBytes <= 0) {
+        qWarning() << "IioSource: Empty scan layout";
+        return false;
+    }
+
+    m_fd = ::open(m_charDevice.toLocal8Bit().constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "IioSource: Cannot open" << m_charDevice << ":" << strerror(errno);
+        disableBuffer();
+        return false;
+    }
+
+    const size_t channels = size_t(m_layout.channels.size());
+    m_readBuffer.assign(size_t(BLOCK_SCANS) * m_layout.scanBytes, 0);
+    m_values.assign(size_t(BLOCK_SCANS) * channels, 0.0f);
+    m_samples.resize(size_t(BLOCK_SCANS) * channels);
+    m_pending = 0;
+    m_periodNs = m_sampleRate > 0.0 ? qint64(1e9 / m_sampleRate) : 0;
+
+    qDebug() << "IioSource: Capturing" << m_layout.channels.size() << "channels from" << m_charDevice
+             << "scan size" << m_layout.scanBytes << "bytes"
+             << (m_layout.isUniform16() ? "(SIMD decode)" : "(generic decode)");
+    return true;
+#else
+    qWarning() << "IioSource: IIO capture is only available on Linux";
+    return false;
+#endif
+}
+
+void IioSource::close()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        disableBuffer();
+    }
+#endif
+}
+
+qint64 IioSource::poll(SourceSink &sink, int timeoutMs)
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0)
+        return -1;
+
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int rv = ::poll(&pfd, 1, timeoutMs);
+    if (rv <= 0)
+        return (rv < 0 && errno != EINTR) ? -1 : 0;
+
+    ssize_t n = ::read(m_fd, m_readBuffer.data() + m_pending, m_readBuffer.size() - size_t(m_pending));
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    if (n == 0) {
+        // End of a stand-in file; don't spin on it
+        if (timeoutMs > 0)
+            ::usleep(useconds_t(timeoutMs) * 1000);
+        return 0;
+    }
+
+    const qint64 arrivalNs = HostClock::nowNs();
+    const int available = m_pending + int(n);
+    const int scans = available / m_layout.scanBytes;
+    const int channels = m_layout.channels.size();
+
+    decodeScans(m_readBuffer.data(), m_values.data(), size_t(scans), m_layout);
+
+    for (int s = 0; s < scans; s++) {
+        qint64 timestampNs;
+        if (m_layout.hasTimestamp) {
+            memcpy(&timestampNs, m_readBuffer.data() + size_t(s) * m_layout.scanBytes + m_layout.timestampOffset,
+                   sizeof(timestampNs));
+        } else {
+            timestampNs = arrivalNs - qint64(scans - 1 - s) * m_periodNs;
+        }
+
+        TelemetrySample *out = &m_samples[size_t(s) * channels];
+        const float *values = &m_values[size_t(s) * channels];
+        for (int c = 0; c < channels; c++) {
+            out[c].timestampNs = timestampNs;
+            out[c].channel = quint16(m_layout.channels[c].index);
+            out[c].link = 0;
+            out[c].value = values[c];
+        }
+    }
+
+    // Keep a trailing partial scan for the next read
+    const int consumed = scans * m_layout.scanBytes;
+    m_pending = available - consumed;
+    if (m_pending > 0)
+        memmove(m_readBuffer.data(), m_readBuffer.data() + consumed, size_t(m_pending));
+
+    m_scansRead += quint64(scans);
+    if (scans > 0)
+        sink.samplesReceived(m_samples.data(), scans * channels);
+    return qint64(scans) * channels;
+#else
+    Q_UNUSED(sink);
+    Q_UNUSED(timeoutMs);
+    return -1;
+#endif
+}
+
+void IioSource::decodeUniform16(const quint8 *src, float *dst, size_t count, const IioChannel &format)
+{
+    const quint16 mask = quint16((1u << format.realBits) - 1u);
+    const int signShift = 16 - format.realBits;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i shiftCount = _mm_cvtsi32_si128(format.shift);
+    const __m128i signCount = _mm_cvtsi32_si128(signShift);
+    const __m128i maskVec = _mm_set1_epi16(qint16(mask));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        v = _mm_and_si128(_mm_srl_epi16(v, shiftCount), maskVec);
+        __m128i lo, hi;
+        if (format.isSigned) {
+            v = _mm_sra_epi16(_mm_sll_epi16(v, signCount), signCount);
+            lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        } else {
+            lo = _mm_unpacklo_epi16(v, zero);
+            hi = _mm_unpackhi_epi16(v, zero);
+        }
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(hi));
+    }
+#elif defined(__ARM_NEON)
+    const int16x8_t shiftVec = vdupq_n_s16(qint16(-format.shift));
+    const int16x8_t signLeft = vdupq_n_s16(qint16(signShift));
+    const int16x8_t signRight = vdupq_n_s16(qint16(-signShift));
+    const uint16x8_t maskVec = vdupq_n_u16(mask);
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src + 2 * i));
+        v = vandq_u16(vshlq_u16(v, shiftVec), maskVec);
+        if (format.isSigned) {
+            int16x8_t s = vshlq_s16(vshlq_s16(vreinterpretq_s16_u16(v), signLeft), signRight);
+            vst1q_f32(dst + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))));
+            vst1q_f32(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))));
+        } else {
+            vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))));
+            vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))));
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        quint16 raw = quint16(src[2 * i] | (src[2 * i + 1] << 8));
+        quint16 v = quint16((raw >> format.shift) & mask);
+        dst[i] = format.isSigned ? float(qint16(quint16(v << signShift)) >> signShift) : float(v);
+    }
+}
+
+void IioSource::decodeScans(const quint8 *src, float *dst, size_t scans, const IioScanLayout &layout)
+{
+    const size_t channels = size_t(layout.channels.size());
+
+    if (layout.isUniform16()) {
+        // Interleaved channels form one contiguous quint16 array
+        decodeUniform16(src, dst, scans * channels, layout.channels.first());
+        return;
+    }
+
+    for (size_t s = 0; s < scans; s++) {
+        const quint8 *scan = src + s * size_t(layout.scanBytes);
+        for (size_t c = 0; c < channels; c++) {
+            const IioChannel &channel = layout.channels[int(c)];
+            const int bytes = channel.storageBits / 8;
+            quint32 raw = 0;
+            for (int b = 0; b < bytes; b++) {
+                const int byteIndex = channel.bigEndian ? b : bytes - 1 - b;
+                raw = (raw << 8) | scan[channel.offset + byteIndex];
+            }
+            raw >>= channel.shift;
+            if (channel.realBits < 32)
+                raw &= (1u << channel.realBits) - 1u;
+
+            if (channel.isSigned && channel.realBits < 32 && (raw & (1u << (channel.realBits - 1))))
+                dst[s * channels + c] = float(qint64(raw) - (qint64(1) << channel.realBits));
+            else if (channel.isSigned)
+                dst[s * channels + c] = float(qint32(raw));
+            else
+                dst[s * channels + c] = float(raw);
+        }
+    }
+}
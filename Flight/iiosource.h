@@ -0,0 +1,112 @@
+#ifndef IIOSOURCE_H
+#define IIOSOURCE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "telemetrysource.h"
+
+#define IIO_DEFAULT_DEVICE      "iio:device0"
+#define IIO_DEFAULT_CHANNEL     "voltage1"
+
+/**
+ * @brief Storage format of one IIO scan element
+ *
+ * Parsed from scan_elements/in_<name>_type, e.g. "le:u12/16>>0".
+ */
+struct IioChannel {
+    QString name;           // "voltage1", ...
+    int index = 0;          // Scan order from scan_elements/in_<name>_index
+    bool bigEndian = false;
+    bool isSigned = false;
+    int realBits = 16;
+    int storageBits = 16;
+    int shift = 0;
+    int offset = 0;         // Byte offset inside one scan, set by IioScanLayout::finalize()
+
+    bool parseType(const QString &type);
+};
+
+/**
+ * @brief Binary layout of one scan as delivered by /dev/iio:deviceN
+ *
+ * Every element is aligned to its own storage size and the scan is padded to the
+ * largest element, as the kernel does. The optional timestamp is an s64 placed
+ * after the channels (it always has the highest scan index).
+ */
+struct IioScanLayout {
+    QVector<IioChannel> channels;
+    bool hasTimestamp = false;
+    int timestampOffset = -1;
+    int scanBytes = 0;
+
+    void finalize();
+
+    // All channels 16-bit little-endian with one format and no padding: the block
+    // is then a plain quint16 array and decodes with the SIMD path
+    bool isUniform16() const;
+};
+
+/**
+ * @brief IIO buffered-capture source
+ *
+ * Enables the scan elements, sizes and enables the kernel buffer, then reads
+ * whole blocks of scans from the character device instead of one sysfs
+ * open/read/parse per sample. Samples carry the scan index as their channel.
+ *
+ * The file constructor is the stand-in for machines without the ADC: it reads
+ * scans in the given layout from any regular file or FIFO and skips all sysfs
+ * setup.
+ */
+class IioSource : public TelemetrySource
+{
+public:
+    static const int BLOCK_SCANS = 1024;        // Scans decoded per read()
+    static const int DEFAULT_BUFFER_LENGTH = 8192;
+
+    explicit IioSource(const QString &device = IIO_DEFAULT_DEVICE,
+                       const QStringList &channels = QStringList() << IIO_DEFAULT_CHANNEL,
+                       double sampleRate = 0.0);
+    IioSource(const QString &path, const IioScanLayout &layout, double sampleRate);
+    ~IioSource() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_fd >= 0; }
+    qint64 poll(SourceSink &sink, int timeoutMs) override;
+    int handle() const override { return m_fd; }
+
+    const IioScanLayout &layout() const { return m_layout; }
+    quint64 scansRead() const { return m_scansRead; }
+
+    static void decodeUniform16(const quint8 *src, float *dst, size_t count, const IioChannel &format);
+    static void decodeScans(const quint8 *src, float *dst, size_t scans, const IioScanLayout &layout);
+
+private:
+    bool configureDevice();
+    void disableBuffer();
+    QString sysfsPath(const QString &attribute) const;
+    static bool writeAttribute(const QString &path, const QByteArray &value);
+    static QByteArray readAttribute(const QString &path);
+
+    QString m_device;
+    QStringList m_channelNames;
+    QString m_charDevice;
+    bool m_standIn;
+    double m_sampleRate;
+    qint64 m_periodNs;
+
+    IioScanLayout m_layout;
+    int m_fd;
+
+    std::vector<quint8> m_readBuffer;
+    std::vector<float> m_values;
+    std::vector<TelemetrySample> m_samples;
+    int m_pending;
+
+    quint64 m_scansRead;
+};
+
+#endif // IIOSOURCE_H
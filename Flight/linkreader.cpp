@@ -0,0 +1,110 @@
+#include <QThread>
+#include <QDebug>
+#include "linkreader.h"
+
+LinkReader::LinkReader(quint8 linkId, TelemetrySource *source, QObject *parent) :
+    QObject(parent),
+    m_linkId(linkId),
+    m_source(source),
+    m_droppedSamples(0)
+{
+    _working = false;
+    _abort = false;
+    m_decoder.setFrameHandler([this](const DecodedFrame &frame) { frameDecoded(frame); });
+}
+
+LinkReader::~LinkReader()
+{
+    delete m_source;
+}
+
+void LinkReader::requestWork()
+{
+    mutex.lock();
+    _working = true;
+    _abort = false;
+    mutex.unlock();
+
+    emit workRequested();
+}
+
+void LinkReader::abort()
+{
+    mutex.lock();
+    if (_working)
+        _abort = true;
+    mutex.unlock();
+}
+
+void LinkReader::doWork()
+{
+    qDebug() << "LinkReader" << m_linkId << "started in Thread" << QThread::currentThreadId();
+
+    bool abort = false;
+    while (!abort)
+    {
+        mutex.lock();
+        abort = _abort;
+        mutex.unlock();
+
+        if (!m_source->isOpen() && !m_source->open())
+        {
+            QThread::msleep(500);  // Retry until the link shows up
+            continue;
+        }
+
+        if (m_source->poll(*this, 10) < 0)
+        {
+            qWarning() << "LinkReader" << m_linkId << "lost its source, reopening";
+            m_source->close();
+            m_decoder.reset();
+        }
+    }
+
+    m_source->close();
+
+    mutex.lock();
+    _working = false;
+    mutex.unlock();
+
+    qDebug() << "LinkReader" << m_linkId << "finished, dropped" << droppedSamples() << "samples";
+
+    emit finished();
+}
+
+void LinkReader::chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs)
+{
+    m_decoder.feed(data, length, timestampNs);
+}
+
+void LinkReader::samplesReceived(const TelemetrySample *samples, int count)
+{
+    // Whole blocks go straight into the ring with a single publish
+    const SampleRing::WriteSpans spans = m_samples.reserve(size_t(count));
+    for (size_t i = 0; i < spans.size(); i++)
+    {
+        spans[i] = samples[i];
+        spans[i].link = m_linkId;
+    }
+    m_samples.commit(spans.size());
+
+    if (spans.size() < size_t(count))
+        m_droppedSamples.fetch_add(quint64(size_t(count) - spans.size()), std::memory_order_relaxed);
+}
+
+void LinkReader::frameDecoded(const DecodedFrame &frame)
+{
+    TelemetrySample sample;
+    sample.timestampNs = frame.timestampNs;
+    sample.channel = frame.cmd;
+    sample.link = m_linkId;
+    sample.value = float(frame.value());
+    publish(sample);
+}
+
+void LinkReader::publish(const TelemetrySample &sample)
+{
+    // Never block the reader; the merger is expected to keep up
+    if (!m_samples.push(sample))
+        m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+}
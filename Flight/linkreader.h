@@ -0,0 +1,61 @@
+#ifndef LINKREADER_H
+#define LINKREADER_H
+
+#include <QObject>
+#include <QMutex>
+#include <atomic>
+#include "RingBuffer.h"
+#include "framedecoder.h"
+#include "telemetrysource.h"
+
+/**
+ * @brief Reader thread of one vehicle link
+ *
+ * Owns its source and decoder, and publishes decoded samples tagged with the
+ * link id into a private SPSC ring that the Vehicle drains on the GUI thread.
+ * Follows the SamplerWorker lifecycle (requestWork / doWork / abort / finished).
+ */
+class LinkReader : public QObject, public SourceSink
+{
+    Q_OBJECT
+public:
+    static const size_t RING_SIZE = 16384;
+    typedef RingBuffer<TelemetrySample, RING_SIZE> SampleRing;
+
+    // Takes ownership of source
+    explicit LinkReader(quint8 linkId, TelemetrySource *source, QObject *parent = nullptr);
+    ~LinkReader();
+
+    void requestWork();
+    void abort();
+
+    quint8 linkId() const { return m_linkId; }
+    SampleRing *samples() { return &m_samples; }
+    quint64 droppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
+
+    void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) override;
+    void samplesReceived(const TelemetrySample *samples, int count) override;
+
+private:
+    void frameDecoded(const DecodedFrame &frame);
+    void publish(const TelemetrySample &sample);
+
+    bool _abort;
+    bool _working;
+    QMutex mutex;
+
+    quint8 m_linkId;
+    TelemetrySource *m_source;
+    FrameDecoder m_decoder;
+    SampleRing m_samples;
+    std::atomic<quint64> m_droppedSamples;
+
+signals:
+    void workRequested();
+    void finished();
+
+public slots:
+    void doWork();
+};
+
+#endif // LINKREADER_H
@@ -0,0 +1,99 @@
+#ifndef LINKSTATS_H
+#define LINKSTATS_H
+
+#include <QString>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Latency figures of one link, measured on the host timeline
+ *
+ * Inter-arrival time is the gap between consecutive received chunks; jitter is
+ * its standard deviation (Welford's running variance). Round-trip time is the
+ * span from writing a probe frame to decoding its echo.
+ *
+ * Single-threaded: owned by the link's reader.
+ */
+class LinkStats
+{
+public:
+    LinkStats() { reset(); }
+
+    void reset()
+    {
+        m_chunks = 0;
+        m_lastArrivalNs = 0;
+        m_gapCount = 0;
+        m_gapMeanNs = 0.0;
+        m_gapM2 = 0.0;
+        m_gapMaxNs = 0;
+        m_rttCount = 0;
+        m_rttSumNs = 0;
+        m_rttMinNs = std::numeric_limits<qint64>::max();
+        m_rttMaxNs = 0;
+    }
+
+    void chunkArrived(qint64 timestampNs)
+    {
+        m_chunks++;
+        if (m_lastArrivalNs > 0 && timestampNs >= m_lastArrivalNs) {
+            const qint64 gapNs = timestampNs - m_lastArrivalNs;
+            m_gapCount++;
+            const double delta = double(gapNs) - m_gapMeanNs;
+            m_gapMeanNs += delta / double(m_gapCount);
+            m_gapM2 += delta * (double(gapNs) - m_gapMeanNs);
+            if (gapNs > m_gapMaxNs)
+                m_gapMaxNs = gapNs;
+        }
+        m_lastArrivalNs = timestampNs;
+    }
+
+    void rttMeasured(qint64 rttNs)
+    {
+        m_rttCount++;
+        m_rttSumNs += rttNs;
+        if (rttNs < m_rttMinNs)
+            m_rttMinNs = rttNs;
+        if (rttNs > m_rttMaxNs)
+            m_rttMaxNs = rttNs;
+    }
+
+    quint64 chunks() const { return m_chunks; }
+    double interArrivalMs() const { return m_gapMeanNs / 1e6; }
+    double jitterMs() const { return m_gapCount > 1 ? std::sqrt(m_gapM2 / double(m_gapCount - 1)) / 1e6 : 0.0; }
+    double maxGapMs() const { return double(m_gapMaxNs) / 1e6; }
+    quint64 rttCount() const { return m_rttCount; }
+    double rttMinMs() const { return m_rttCount ? double(m_rttMinNs) / 1e6 : 0.0; }
+    double rttAvgMs() const { return m_rttCount ? double(m_rttSumNs) / double(m_rttCount) / 1e6 : 0.0; }
+    double rttMaxMs() const { return double(m_rttMaxNs) / 1e6; }
+
+    QString summary() const
+    {
+        QString text = QString("%1 chunks, inter-arrival %2 ms, jitter %3 ms, max gap %4 ms")
+                           .arg(m_chunks)
+                           .arg(interArrivalMs(), 0, 'f', 3)
+                           .arg(jitterMs(), 0, 'f', 3)
+                           .arg(maxGapMs(), 0, 'f', 3);
+        if (m_rttCount > 0)
+            text += QString(", RTT min/avg/max %1/%2/%3 ms over %4 probes")
+                        .arg(rttMinMs(), 0, 'f', 3)
+                        .arg(rttAvgMs(), 0, 'f', 3)
+                        .arg(rttMaxMs(), 0, 'f', 3)
+                        .arg(m_rttCount);
+        return text;
+    }
+
+private:
+    quint64 m_chunks;
+    qint64 m_lastArrivalNs;
+    quint64 m_gapCount;
+    double m_gapMeanNs;
+    double m_gapM2;
+    qint64 m_gapMaxNs;
+    quint64 m_rttCount;
+    qint64 m_rttSumNs;
+    qint64 m_rttMinNs;
+    qint64 m_rttMaxNs;
+};
+
+#endif // LINKSTATS_H
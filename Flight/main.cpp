@@ -4,22 +4,248 @@
 #include <QtQuickControls2/QQuickStyle>
 #include <QQuickWindow>
 #include <QSGRendererInterface>
-<<<<<<< HEAD
+#include <QCommandLineParser>
 #include <QtDebug>
-#include <QQueue>
+#include <QMap>
 #include <QThread>
+#include <QTimer>
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 
 #include "datasource.h"
+#include "fleetmanager.h"
+#include "offlinedecoder.h"
+#include "pipelineloadtest.h"
 #include "samplerworker.h"
-=======
-#include "SineWaveTest.h"
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
+#include "sinewavetest.h"
+#include "vehicle.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+volatile std::sig_atomic_t quitRequested = 0;
+
+void requestQuit(int)
+{
+    quitRequested = 1;
+}
+
+// Modes that run without a display, decided before any application object exists
+bool isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        const QByteArray arg(argv[i]);
+        for (const char *option : {"--loadtest", "--acquire"}) {
+            if (arg == option || arg.startsWith(QByteArray(option) + '='))
+                return true;
+        }
+    }
+    return false;
+}
+}
 
 int main(int argc, char *argv[])
 {
     int rv;
+    const bool headless = isHeadless(argc, argv);
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
-    QApplication app(argc, argv);
+    std::unique_ptr<QCoreApplication> app(headless ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+#if defined(Q_OS_WIN)
+    // A WIN32 executable has no console of its own: report to the one it was started from
+    if (headless && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        std::freopen("CONOUT$", "w", stdout);
+        std::freopen("CONOUT$", "w", stderr);
+    }
+#endif
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption linkOption("link",
+                                  "Add a vehicle link: serial:<port>[:<baud>] or udp:<port>[:<address>]. Repeatable.",
+                                  "spec");
+    parser.addOption(linkOption);
+    QCommandLineOption fleetOption("fleet", "Treat every --link as a separate vehicle on the shared fleet pool.");
+    parser.addOption(fleetOption);
+    QCommandLineOption ioThreadsOption("io-threads", "Number of fleet I/O threads.", "count", "2");
+    parser.addOption(ioThreadsOption);
+    QCommandLineOption captureOption("capture", "Record every raw chunk the sampler reads to a capture file.", "file");
+    parser.addOption(captureOption);
+    QCommandLineOption replayOption("replay", "Feed a raw capture file through the sampler instead of a live source.", "file");
+    parser.addOption(replayOption);
+    QCommandLineOption replaySpeedOption("replay-speed", "Replay speed: 1 for real time, N for N times faster, max for as fast as possible.", "speed", "1");
+    parser.addOption(replaySpeedOption);
+    QCommandLineOption serialOption("serial", "Read the sampler from this serial port.", "port");
+    parser.addOption(serialOption);
+    QCommandLineOption lowLatencyOption("low-latency", "Tune the sampler's serial port for latency (ASYNC_LOW_LATENCY, direct reads).");
+    parser.addOption(lowLatencyOption);
+    QCommandLineOption decodeOption("decode", "Decode a capture file on all cores, print a summary and exit.", "file");
+    parser.addOption(decodeOption);
+    QCommandLineOption acquireOption("acquire",
+                                     "Run the sine generator headless into the shared-memory ring <name> until interrupted.",
+                                     "name");
+    parser.addOption(acquireOption);
+    QCommandLineOption acquireRateOption("acquire-rate", "Sample rate of --acquire in Hz.", "hz", "1000");
+    parser.addOption(acquireRateOption);
+    QCommandLineOption acquireCapacityOption("acquire-capacity", "Shared ring size of --acquire in samples.", "samples", "65536");
+    parser.addOption(acquireCapacityOption);
+    QCommandLineOption acquireChannelsOption("acquire-channels", "Channel count of --acquire.", "count", "4");
+    parser.addOption(acquireChannelsOption);
+    QCommandLineOption acquirePlaybackOption("acquire-playback", "Play a sample file, looped, into --acquire's ring instead of generating.", "file");
+    parser.addOption(acquirePlaybackOption);
+    QCommandLineOption acquireSpeedOption("acquire-speed", "Playback speed of --acquire-playback: 1 for the recorded rate, N for N times faster.", "speed", "1");
+    parser.addOption(acquireSpeedOption);
+    QCommandLineOption loadTestOption("loadtest",
+                                      "Run the acquisition, decimation and recording pipeline headless for <seconds>, print throughput, drops, latency and CPU, and exit.",
+                                      "seconds");
+    parser.addOption(loadTestOption);
+    QCommandLineOption loadTestRateOption("loadtest-rate", "Sample rate of --loadtest in Hz.", "hz", "1000000");
+    parser.addOption(loadTestRateOption);
+    QCommandLineOption loadTestChannelsOption("loadtest-channels", "Channel count of --loadtest.", "count", "4");
+    parser.addOption(loadTestChannelsOption);
+    QCommandLineOption loadTestCapacityOption("loadtest-capacity", "Ring size of --loadtest in samples.", "samples", "1048576");
+    parser.addOption(loadTestCapacityOption);
+    QCommandLineOption loadTestRecordOption("loadtest-record", "Keep --loadtest's recording in this sample file.", "file");
+    parser.addOption(loadTestRecordOption);
+    QCommandLineOption attachOption("attach", "Show the samples of an --acquire process instead of generating them.", "name");
+    parser.addOption(attachOption);
+    parser.process(*app);
+
+    if (parser.isSet(decodeOption)) {
+        struct CountingSink : public SourceSink {
+            QMap<quint16, quint64> perChannel;
+            void chunkReceived(const quint8 *, qint64, qint64) override {}
+            void samplesReceived(const TelemetrySample *samples, int count) override
+            {
+                for (int i = 0; i < count; i++)
+                    perChannel[samples[i].channel]++;
+            }
+        } sink;
+
+        OfflineDecoder decoder;
+        if (!decoder.decodeFile(parser.value(decodeOption), sink))
+            return -1;
+        for (auto it = sink.perChannel.constBegin(); it != sink.perChannel.constEnd(); ++it)
+            qDebug() << "  cmd" << it.key() << ":" << it.value() << "frames";
+        return 0;
+    }
+
+    if (parser.isSet(loadTestOption)) {
+        bool secondsOk = false;
+        const double seconds = parser.value(loadTestOption).toDouble(&secondsOk);
+        if (!secondsOk || !(seconds > 0.0) || seconds > PipelineLoadTest::MAX_SECONDS) {
+            qWarning() << "--loadtest needs a duration of up to" << PipelineLoadTest::MAX_SECONDS << "seconds, not"
+                       << parser.value(loadTestOption);
+            return -1;
+        }
+        bool channelsOk = false;
+        const int channels = parser.value(loadTestChannelsOption).toInt(&channelsOk);
+        if (!channelsOk || channels < 1 || channels > SineWaveTest::MAX_CHANNELS) {
+            qWarning() << "--loadtest-channels needs 1 to" << SineWaveTest::MAX_CHANNELS << "channels, not"
+                       << parser.value(loadTestChannelsOption);
+            return -1;
+        }
+        bool rateOk = false;
+        const double sampleRate = parser.value(loadTestRateOption).toDouble(&rateOk);
+        if (!rateOk || !(sampleRate > 0.0) || !std::isfinite(sampleRate)) {
+            qWarning() << "--loadtest-rate needs a positive rate in Hz, not" << parser.value(loadTestRateOption);
+            return -1;
+        }
+        bool capacityOk = false;
+        const qulonglong capacity = parser.value(loadTestCapacityOption).toULongLong(&capacityOk);
+        const int maxCapacity = SineWaveTest::maxBufferCapacity(channels);
+        if (!capacityOk || capacity < qulonglong(SineWaveTest::MIN_BUFFER_CAPACITY) || capacity > qulonglong(maxCapacity)) {
+            qWarning() << "--loadtest-capacity needs" << SineWaveTest::MIN_BUFFER_CAPACITY << "to" << maxCapacity
+                       << "samples for" << channels << "channels, not" << parser.value(loadTestCapacityOption);
+            return -1;
+        }
+        PipelineLoadTest loadTest(sampleRate, channels, size_t(capacity));
+        if (parser.isSet(loadTestRecordOption))
+            loadTest.setRecordFile(parser.value(loadTestRecordOption));
+        if (!loadTest.run(seconds))
+            return -1;
+        loadTest.printReport();
+        return 0;
+    }
+
+    if (parser.isSet(acquireOption)) {
+        std::unique_ptr<SampleFileReader> playback;
+        if (parser.isSet(acquirePlaybackOption)) {
+            playback.reset(new SampleFileReader);
+            if (!playback->open(parser.value(acquirePlaybackOption)))
+                return -1;
+        }
+        bool channelsOk = true;
+        const int channels = playback ? playback->channels() : parser.value(acquireChannelsOption).toInt(&channelsOk);
+        if (!channelsOk || channels < 1 || channels > SineWaveTest::MAX_CHANNELS) {
+            qWarning() << "--acquire needs 1 to" << SineWaveTest::MAX_CHANNELS << "channels, not"
+                       << (playback ? QString::number(channels) : parser.value(acquireChannelsOption));
+            return -1;
+        }
+        bool speedOk = true;
+        const double playbackSpeed = playback ? parser.value(acquireSpeedOption).toDouble(&speedOk) : 1.0;
+        if (!speedOk || !(playbackSpeed > 0.0)) {
+            qWarning() << "--acquire-speed needs a positive speed, not" << parser.value(acquireSpeedOption);
+            return -1;
+        }
+        bool rateOk = false;
+        const double sampleRate = parser.value(acquireRateOption).toDouble(&rateOk);
+        if (!rateOk || !(sampleRate > 0.0)) {
+            qWarning() << "--acquire-rate needs a positive rate in Hz, not" << parser.value(acquireRateOption);
+            return -1;
+        }
+        bool capacityOk = false;
+        const qulonglong capacity = parser.value(acquireCapacityOption).toULongLong(&capacityOk);
+        const int maxCapacity = SineWaveTest::maxBufferCapacity(channels);
+        if (!capacityOk || capacity < qulonglong(SineWaveTest::MIN_BUFFER_CAPACITY) || capacity > qulonglong(maxCapacity)) {
+            qWarning() << "--acquire-capacity needs" << SineWaveTest::MIN_BUFFER_CAPACITY << "to" << maxCapacity
+                       << "samples for" << channels << "channels, not" << parser.value(acquireCapacityOption);
+            return -1;
+        }
+        SharedSampleWriter ring;
+        if (!ring.create(parser.value(acquireOption).toStdString(), size_t(capacity), channels)) {
+            if (errno == EEXIST)
+                qWarning() << "Shared ring" << parser.value(acquireOption) << "is still written by another process";
+            else
+                qWarning() << "Cannot create shared ring" << parser.value(acquireOption) << ":" << std::strerror(errno);
+            return -1;
+        }
+        qDebug() << "Acquiring into shared ring" << QString::fromStdString(ring.name()) << "of" << ring.capacity() << "samples x" << ring.columns() << "channels";
+
+        QThread acquisitionThread;
+        auto worker = new SineWaveWorker(nullptr);
+        GeneratorParams params(channels);
+        params.sampleRate = sampleRate;
+        worker->setParams(params);
+        if (playback)
+            worker->setPlayback(std::move(playback), playbackSpeed);
+        worker->setSharedRing(&ring);
+        worker->moveToThread(&acquisitionThread);
+        QObject::connect(&acquisitionThread, &QThread::started, worker, &SineWaveWorker::start);
+        QObject::connect(&acquisitionThread, &QThread::finished, worker, &QObject::deleteLater);
+
+        // Leave through the event loop so the ring is marked closed and unlinked
+        std::signal(SIGINT, requestQuit);
+        std::signal(SIGTERM, requestQuit);
+        QTimer quitPoll;
+        QObject::connect(&quitPoll, &QTimer::timeout, app.get(), []() {
+            if (quitRequested)
+                QCoreApplication::quit();
+        });
+        quitPoll.start(100);
+
+        acquisitionThread.start();
+        rv = app->exec();
+        acquisitionThread.quit();
+        acquisitionThread.wait();
+        return rv;
+    }
 
     bool openGLSupported = QQuickWindow::graphicsApi() == QSGRendererInterface::OpenGLRhi;
     if (!openGLSupported) {
@@ -29,10 +255,47 @@ int main(int argc, char *argv[])
 
     QQuickStyle::setStyle("Basic");
 
-    QQueue<QPointF> samplesQueue;
+    if (parser.isSet(attachOption))
+        SineWaveTest::setDefaultSharedSource(parser.value(attachOption));
+
+    // 0 replays as fast as possible
+    double replaySpeed = 0.0;
+    if (parser.isSet(replayOption) && parser.value(replaySpeedOption) != "max") {
+        bool ok = false;
+        replaySpeed = parser.value(replaySpeedOption).toDouble(&ok);
+        if (!ok || !(replaySpeed > 0.0)) {
+            qWarning() << "--replay-speed needs a positive number or max, not" << parser.value(replaySpeedOption);
+            return -1;
+        }
+    }
+
+    // All links of the vehicle are merged onto one host-time axis
+    Vehicle vehicle;
+    // Bench testing: one board per link, multiplexed on a small thread pool
+    FleetManager fleet(parser.value(ioThreadsOption).toInt());
+    for (const QString &spec : parser.values(linkOption)) {
+        if (parser.isSet(fleetOption))
+            fleet.addVehicle(spec, Vehicle::createSource(spec));
+        else
+            vehicle.addLink(spec);
+    }
+
+    SamplerWorker::SampleRing samples;
     auto threadSampler = new QThread();
-    auto samplerWorker = new SamplerWorker(&samplesQueue);
-    DataSource dataSource(&samplesQueue);
+    auto samplerWorker = new SamplerWorker(&samples);
+    if (parser.isSet(replayOption)) {
+        samplerWorker->setReplayFile(parser.value(replayOption), replaySpeed);
+        samplerWorker->setSource(DATASOURCE_REPLAY);
+    }
+    if (parser.isSet(serialOption)) {
+        samplerWorker->setSerialPort(parser.value(serialOption));
+        samplerWorker->setSource(DATASOURCE_SERIAL);
+    }
+    if (parser.isSet(lowLatencyOption))
+        samplerWorker->setSerialLowLatency(true);
+    if (parser.isSet(captureOption))
+        samplerWorker->setCaptureFile(parser.value(captureOption));
+    DataSource dataSource(&samples);
 
     samplerWorker->moveToThread(threadSampler);
 
@@ -41,26 +304,24 @@ int main(int argc, char *argv[])
     });
     QObject::connect(threadSampler, &QThread::started, samplerWorker, &SamplerWorker::doWork);
     QObject::connect(samplerWorker, &SamplerWorker::finished, threadSampler, &QThread::quit, Qt::DirectConnection);
-    QObject::connect(&app, &QCoreApplication::aboutToQuit, samplerWorker, &SamplerWorker::abort);
+    QObject::connect(app.get(), &QCoreApplication::aboutToQuit, samplerWorker, &SamplerWorker::abort);
     QObject::connect(samplerWorker, &SamplerWorker::updateCurve, &dataSource, &DataSource::updateCurve);
 
     QQmlApplicationEngine engine;
-<<<<<<< HEAD
 
-=======
-    
     // Register QML types (this should be called before loading QML)
     qmlRegisterType<SineWaveTest>("Flight.Backend", 1, 0, "SineWaveTest");
-    
+
     // Register OpenGL support flag
->>>>>>> bc523e3f8eae207881223cc6b330ef17e9f38592
     engine.rootContext()->setContextProperty("openGLSupported", openGLSupported);
     engine.rootContext()->setContextProperty("dataSource", &dataSource);
     engine.rootContext()->setContextProperty("sampleWorker", samplerWorker);
+    engine.rootContext()->setContextProperty("vehicle", &vehicle);
+    engine.rootContext()->setContextProperty("fleet", &fleet);
     QObject::connect(
         &engine,
         &QQmlApplicationEngine::objectCreationFailed,
-        &app,
+        app.get(),
         [](const QUrl &url) {
             qDebug() << "QML object creation FAILED for URL:" << url;
             QCoreApplication::exit(-1);
@@ -102,12 +363,19 @@ int main(int argc, char *argv[])
     qDebug() << "QML setup complete, ready to start application...";
 
     samplerWorker->requestWork();
+    if (vehicle.linkCount() > 0)
+        vehicle.start();
+    if (fleet.vehicleCount() > 0)
+        fleet.start();
 
     qDebug() << "Starting application event loop...";
     qDebug() << "Main window should be visible now. Close it to exit.";
-    rv = app.exec();
+    rv = app->exec();
     qDebug() << "Application event loop ended with code:" << rv;
 
+    vehicle.stop();
+    fleet.stop();
+
     samplerWorker->abort();
     if (threadSampler->isRunning()) {
         threadSampler->quit();
@@ -0,0 +1,225 @@
+#include "minmaxdecimator.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+const float EMPTY_LO = std::numeric_limits<float>::infinity();
+const float EMPTY_HI = -std::numeric_limits<float>::infinity();
+
+// Four float lanes, as in signalgenerator.cpp
+#if defined(__SSE2__)
+typedef __m128 F32x4;
+inline F32x4 loadF(const float *p) { return _mm_loadu_ps(p); }
+inline F32x4 minF(F32x4 a, F32x4 b) { return _mm_min_ps(a, b); }
+inline F32x4 maxF(F32x4 a, F32x4 b) { return _mm_max_ps(a, b); }
+inline float lowestF(F32x4 a)
+{
+    a = _mm_min_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_min_ss(a, _mm_shuffle_ps(a, a, 1)));
+}
+inline float highestF(F32x4 a)
+{
+    a = _mm_max_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_max_ss(a, _mm_shuffle_ps(a, a, 1)));
+}
+inline F32x4 splatF(float x) { return _mm_set1_ps(x); }
+inline F32x4 equalF(F32x4 a, F32x4 b) { return _mm_cmpeq_ps(a, b); }
+inline F32x4 orF(F32x4 a, F32x4 b) { return _mm_or_ps(a, b); }
+inline unsigned laneBits(F32x4 mask) { return unsigned(_mm_movemask_ps(mask)); }
+#elif defined(__ARM_NEON)
+typedef float32x4_t F32x4;
+inline F32x4 loadF(const float *p) { return vld1q_f32(p); }
+inline F32x4 minF(F32x4 a, F32x4 b) { return vminq_f32(a, b); }
+inline F32x4 maxF(F32x4 a, F32x4 b) { return vmaxq_f32(a, b); }
+inline float lowestF(F32x4 a)
+{
+    const float32x2_t half = vpmin_f32(vget_low_f32(a), vget_high_f32(a));
+    return vget_lane_f32(vpmin_f32(half, half), 0);
+}
+inline float highestF(F32x4 a)
+{
+    const float32x2_t half = vpmax_f32(vget_low_f32(a), vget_high_f32(a));
+    return vget_lane_f32(vpmax_f32(half, half), 0);
+}
+inline F32x4 splatF(float x) { return vdupq_n_f32(x); }
+inline F32x4 equalF(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vceqq_f32(a, b)); }
+inline F32x4 orF(F32x4 a, F32x4 b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline unsigned laneBits(F32x4 mask)
+{
+    static const uint32_t weights[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(weights));
+    const uint32x2_t half = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(half, half), 0);
+}
+#endif
+
+// Whether, in y[0..count), hi turns up before lo does: an early-exit scan 16
+// at a time; only the block holding the first of them is looked at sample by sample
+bool hiBeforeLo(const float *y, size_t count, float lo, float hi)
+{
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    const F32x4 lo4 = splatF(lo), hi4 = splatF(hi);
+    for (; i + 16 <= count; i += 16) {
+        const F32x4 a = loadF(y + i), b = loadF(y + i + 4), c = loadF(y + i + 8), d = loadF(y + i + 12);
+        const F32x4 any = orF(orF(orF(equalF(a, lo4), equalF(a, hi4)), orF(equalF(b, lo4), equalF(b, hi4))),
+                              orF(orF(equalF(c, lo4), equalF(c, hi4)), orF(equalF(d, lo4), equalF(d, hi4))));
+        if (laneBits(any) == 0)
+            continue;
+
+        // One bit per sample of the block, then the lowest one set decides
+        const unsigned loBits = laneBits(equalF(a, lo4)) | laneBits(equalF(b, lo4)) << 4
+                                | laneBits(equalF(c, lo4)) << 8 | laneBits(equalF(d, lo4)) << 12;
+        const unsigned hiBits = laneBits(equalF(a, hi4)) | laneBits(equalF(b, hi4)) << 4
+                                | laneBits(equalF(c, hi4)) << 8 | laneBits(equalF(d, hi4)) << 12;
+        const unsigned first = (loBits | hiBits) & (0u - (loBits | hiBits));
+        return (loBits & first) == 0;
+    }
+#endif
+    for (; i < count; i++) {
+        if (y[i] == lo)
+            return false;
+        if (y[i] == hi)
+            return true;
+    }
+    return false;
+}
+}
+
+MinMaxDecimator::MinMaxDecimator() :
+    m_bucketSize(1),
+    m_filled(0),
+    m_carried(0),
+    m_bucketStart(0.0)
+{
+}
+
+void MinMaxDecimator::reset(int channels, size_t bucketSize)
+{
+    m_bucketSize = std::max<size_t>(1, bucketSize);
+    m_filled = 0;
+    m_carried = 0;
+    m_lo.assign(size_t(channels), EMPTY_LO);
+    m_hi.assign(size_t(channels), EMPTY_HI);
+    m_hiFirst.assign(size_t(channels), 0);
+    m_times.clear();
+    m_values.resize(size_t(channels));
+    for (std::vector<float> &values : m_values)
+        values.clear();
+}
+
+void MinMaxDecimator::clearPoints()
+{
+    m_carried = m_filled;
+    m_times.clear();
+    for (std::vector<float> &values : m_values)
+        values.clear();
+}
+
+void MinMaxDecimator::discardFront(size_t samples)
+{
+    if (samples == 0)
+        return;
+
+    // Bucket k since clearPoints() starts k * m_bucketSize - m_carried samples in
+    const size_t buckets = m_times.size() / 2;
+    const size_t reach = samples + m_carried;
+    const size_t bad = std::min(buckets, (reach + m_bucketSize - 1) / m_bucketSize);
+    m_times.erase(m_times.begin(), m_times.begin() + long(2 * bad));
+    for (std::vector<float> &values : m_values)
+        values.erase(values.begin(), values.begin() + long(2 * bad));
+
+    if (buckets * m_bucketSize < reach) {
+        m_filled = 0;
+        std::fill(m_lo.begin(), m_lo.end(), EMPTY_LO);
+        std::fill(m_hi.begin(), m_hi.end(), EMPTY_HI);
+        std::fill(m_hiFirst.begin(), m_hiFirst.end(), 0);
+    }
+}
+
+void MinMaxDecimator::add(const double *t, const float *const *y, size_t count)
+{
+    const size_t channels = m_values.size();
+
+    for (size_t done = 0; done < count;) {
+        const size_t n = std::min(count - done, m_bucketSize - m_filled);
+        if (m_filled == 0)
+            m_bucketStart = t[done];
+
+        for (size_t c = 0; c < channels; c++) {
+            if (!y[c])
+                continue;
+            float lo, hi;
+            minMax(y[c] + done, n, lo, hi);
+            const bool newLo = lo < m_lo[c];
+            const bool newHi = hi > m_hi[c];
+            if (newLo && newHi) {
+                // Both from this run: whichever comes first in it
+                m_hiFirst[c] = hiBeforeLo(y[c] + done, n, lo, hi);
+            } else if (newLo || newHi) {
+                m_hiFirst[c] = newLo;  // The one from this run is the later one
+            }
+            m_lo[c] = std::min(m_lo[c], lo);
+            m_hi[c] = std::max(m_hi[c], hi);
+        }
+        m_filled += n;
+        done += n;
+
+        if (m_filled == m_bucketSize) {
+            m_times.push_back(m_bucketStart);
+            m_times.push_back(t[done - 1]);
+            for (size_t c = 0; c < channels; c++) {
+                m_values[c].push_back(m_hiFirst[c] ? m_hi[c] : m_lo[c]);
+                m_values[c].push_back(m_hiFirst[c] ? m_lo[c] : m_hi[c]);
+                m_lo[c] = EMPTY_LO;
+                m_hi[c] = EMPTY_HI;
+                m_hiFirst[c] = 0;
+            }
+            m_filled = 0;
+        }
+    }
+}
+
+void MinMaxDecimator::minMax(const float *y, size_t count, float &lo, float &hi)
+{
+    size_t i = 0;
+    lo = EMPTY_LO;
+    hi = EMPTY_HI;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    // Four independent pairs of accumulators keep the min/max latency off the critical path
+    if (count >= 16) {
+        F32x4 lo0 = loadF(y), lo1 = loadF(y + 4), lo2 = loadF(y + 8), lo3 = loadF(y + 12);
+        F32x4 hi0 = lo0, hi1 = lo1, hi2 = lo2, hi3 = lo3;
+        for (i = 16; i + 16 <= count; i += 16) {
+            const F32x4 a = loadF(y + i), b = loadF(y + i + 4), c = loadF(y + i + 8), d = loadF(y + i + 12);
+            lo0 = minF(lo0, a);
+            hi0 = maxF(hi0, a);
+            lo1 = minF(lo1, b);
+            hi1 = maxF(hi1, b);
+            lo2 = minF(lo2, c);
+            hi2 = maxF(hi2, c);
+            lo3 = minF(lo3, d);
+            hi3 = maxF(hi3, d);
+        }
+        for (; i + 4 <= count; i += 4) {
+            const F32x4 a = loadF(y + i);
+            lo0 = minF(lo0, a);
+            hi0 = maxF(hi0, a);
+        }
+        lo = lowestF(minF(minF(lo0, lo1), minF(lo2, lo3)));
+        hi = highestF(maxF(maxF(hi0, hi1), maxF(hi2, hi3)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        lo = std::min(lo, y[i]);
+        hi = std::max(hi, y[i]);
+    }
+}
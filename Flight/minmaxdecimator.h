@@ -0,0 +1,64 @@
+#ifndef MINMAXDECIMATOR_H
+#define MINMAXDECIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Peak-preserving decimation for display: the minimum and maximum of every bucket
+ *
+ * Samples are cut into buckets of bucketSize() (one pixel column's worth) and
+ * each completed bucket becomes two points per channel: its minimum and its
+ * maximum in the order they occurred, the first at the bucket's first timestamp
+ * and the second at its last, so a falling edge is drawn falling. A spike of a
+ * single sample therefore always reaches the screen, where taking every n-th
+ * sample loses it unless it happens to land on the pick.
+ *
+ * The input is columnar, one contiguous array per channel as the rings store
+ * it, so the reduction runs along each column four floats at a time (SSE2 or
+ * NEON, scalar elsewhere). A bucket may span several add() calls: the one in
+ * progress is carried over, so ring spans and flushes can be fed as they come.
+ */
+class MinMaxDecimator
+{
+public:
+    MinMaxDecimator();
+
+    // Drops the points and the bucket in progress
+    void reset(int channels, size_t bucketSize);
+    int channels() const { return int(m_values.size()); }
+    size_t bucketSize() const { return m_bucketSize; }
+
+    // The next count samples: t their timestamps, y one array per channel. A
+    // null array skips that channel; its points for the buckets completed here
+    // are only meaningful if it was fed for the whole bucket.
+    void add(const double *t, const float *const *y, size_t count);
+
+    // Two per completed bucket, until clearPoints()
+    size_t pointCount() const { return m_times.size(); }
+    const double *times() const { return m_times.data(); }
+    const float *values(int channel) const { return m_values[size_t(channel)].data(); }
+    void clearPoints();
+
+    // The first samples added since clearPoints() were bad (overwritten while
+    // read): drops the points of every bucket that took any of them, and restarts
+    // the bucket in progress if it did. The other buckets are kept.
+    void discardFront(size_t samples);
+
+    // Minimum and maximum of y[0..count), count > 0
+    static void minMax(const float *y, size_t count, float &lo, float &hi);
+
+private:
+    size_t m_bucketSize;
+    size_t m_filled;         // Samples in the bucket in progress
+    size_t m_carried;        // Of those, how many it held at clearPoints()
+    double m_bucketStart;    // Its first timestamp
+    std::vector<float> m_lo;  // Its running extremes per channel
+    std::vector<float> m_hi;
+    std::vector<unsigned char> m_hiFirst;  // Whether the maximum came first
+
+    std::vector<double> m_times;
+    std::vector<std::vector<float>> m_values;
+};
+
+#endif // MINMAXDECIMATOR_H
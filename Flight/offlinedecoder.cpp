@@ -0,0 +1,210 @@
+#include "offlinedecoder.h"
+#include <QDebug>
+#include <QFile>
+#include <QList>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include "frame.h"
+#include "framedecoder.h"
+
+OfflineDecoder::OfflineDecoder(int threads) :
+    m_threadCount(threads > 0 ? threads : std::max(1, QThread::idealThreadCount())),
+    m_data(nullptr),
+    m_size(0),
+    m_isCapture(false),
+    m_nextSegment(0),
+    m_deliveredSegments(0),
+    m_framesDecoded(0),
+    m_checksumErrors(0),
+    m_bytesDecoded(0),
+    m_elapsedNs(0)
+{
+}
+
+bool OfflineDecoder::decodeFile(const QString &path, SourceSink &sink)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "OfflineDecoder: Cannot open" << path << ":" << file.errorString();
+        return false;
+    }
+
+    uchar *mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+    if (!mapped) {
+        qWarning() << "OfflineDecoder: Cannot map" << path;
+        return false;
+    }
+
+    const bool ok = decode(mapped, file.size(), sink);
+    file.unmap(mapped);
+
+    qDebug() << "OfflineDecoder: Decoded" << m_framesDecoded << "frames," << m_checksumErrors
+             << "checksum errors from" << path << "on" << m_threadCount << "threads at"
+             << QString::number(throughputBytesPerSecond() / 1e6, 'f', 1) << "MB/s";
+    return ok;
+}
+
+bool OfflineDecoder::decode(const quint8 *data, qint64 size, SourceSink &sink)
+{
+    const qint64 startNs = HostClock::nowNs();
+
+    m_data = data;
+    m_size = size;
+    m_isCapture = m_index.attach(data, size);
+    m_framesDecoded = 0;
+    m_checksumErrors = 0;
+    m_bytesDecoded = 0;
+
+    findBoundaries();
+    const int segmentCount = int(m_boundaries.size()) - 1;
+    m_segments.clear();
+    m_segments.resize(size_t(std::max(segmentCount, 0)));
+    m_nextSegment = 0;
+    m_deliveredSegments = 0;
+
+    QList<QThread *> threads;
+    for (int i = 0; i < std::min(m_threadCount, segmentCount); i++) {
+        threads.append(QThread::create([this]() { workerLoop(); }));
+        threads.last()->start();
+    }
+
+    // Stitch: hand the segments over strictly in file order
+    for (int i = 0; i < segmentCount; i++) {
+        Segment &segment = m_segments[size_t(i)];
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_segmentDone.wait(lock, [&segment]() { return segment.done; });
+        }
+
+        if (!segment.samples.empty())
+            sink.samplesReceived(segment.samples.data(), int(segment.samples.size()));
+        m_framesDecoded += segment.frames;
+        m_checksumErrors += segment.checksumErrors;
+        std::vector<TelemetrySample>().swap(segment.samples);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_deliveredSegments = i + 1;
+        }
+        m_windowMoved.notify_all();
+    }
+
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    m_bytesDecoded = quint64(size);
+    m_elapsedNs = HostClock::nowNs() - startNs;
+    m_data = nullptr;
+    return true;
+}
+
+double OfflineDecoder::throughputBytesPerSecond() const
+{
+    return m_elapsedNs > 0 ? double(m_bytesDecoded) * 1e9 / double(m_elapsedNs) : 0.0;
+}
+
+void OfflineDecoder::findBoundaries()
+{
+    m_boundaries.clear();
+
+    if (!m_isCapture) {
+        for (qint64 offset = 0; offset < m_size; offset += SEGMENT_SIZE)
+            m_boundaries.push_back({offset, 0});
+        m_boundaries.push_back({m_size, 0});
+        return;
+    }
+
+    // Records can only be walked from the start; this touches the headers only
+    RawCaptureRecord record;
+    qint64 nextBoundary = 0;
+    for (;;) {
+        const Boundary boundary = {m_index.offset(), m_index.lastNs()};
+        if (!m_index.next(record))
+            break;
+        if (boundary.offset >= nextBoundary) {
+            m_boundaries.push_back(boundary);
+            nextBoundary = boundary.offset + SEGMENT_SIZE;
+        }
+    }
+    m_boundaries.push_back({m_index.offset(), m_index.lastNs()});
+}
+
+void OfflineDecoder::decodeSegment(int index, Segment &segment)
+{
+    const Boundary &begin = m_boundaries[size_t(index)];
+    const qint64 end = m_boundaries[size_t(index) + 1].offset;
+
+    // Smallest frame on the wire is FRAME_START, cmd, length and checksum
+    segment.samples.reserve(size_t((end - begin.offset) / Frame::FRAME_NUM_EXTRA_BYTES));
+
+    FrameDecoder decoder;
+    decoder.setFrameHandler([&segment](const DecodedFrame &frame) {
+        TelemetrySample sample;
+        sample.timestampNs = frame.timestampNs;
+        sample.channel = frame.cmd;
+        sample.link = 0;
+        sample.value = float(frame.value());
+        segment.samples.push_back(sample);
+    });
+
+    // Bytes before the first FRAME_START are skipped by the idle decoder, exactly
+    // as the previous segment's decoder would have seen them
+    if (!m_isCapture) {
+        decoder.feed(m_data + begin.offset, end - begin.offset, 0);
+
+        const void *next = memchr(m_data + end, Frame::FRAME_START, size_t(m_size - end));
+        const qint64 tailEnd = next ? static_cast<const quint8 *>(next) - m_data : m_size;
+        decoder.feed(m_data + end, tailEnd - end, 0);
+    } else {
+        RawCaptureReader reader = m_index;
+        reader.seek(begin.offset, begin.lastNs);
+
+        RawCaptureRecord record;
+        while (reader.offset() < end && reader.next(record))
+            decoder.feed(record.data, record.length, record.timestampNs);
+
+        // Finish the frame crossing the boundary, up to where the next segment starts
+        while (reader.next(record)) {
+            const void *next = memchr(record.data, Frame::FRAME_START, size_t(record.length));
+            if (next) {
+                decoder.feed(record.data, static_cast<const quint8 *>(next) - record.data, record.timestampNs);
+                break;
+            }
+            decoder.feed(record.data, record.length, record.timestampNs);
+        }
+    }
+
+    segment.frames = decoder.framesDecoded();
+    segment.checksumErrors = decoder.checksumErrors();
+}
+
+void OfflineDecoder::workerLoop()
+{
+    const int segmentCount = int(m_segments.size());
+    const int window = m_threadCount * MAX_SEGMENTS_IN_FLIGHT;
+
+    for (;;) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_windowMoved.wait(lock, [this, segmentCount, window]() {
+                return m_nextSegment >= segmentCount || m_nextSegment < m_deliveredSegments + window;
+            });
+            if (m_nextSegment >= segmentCount)
+                return;
+            index = m_nextSegment++;
+        }
+
+        Segment &segment = m_segments[size_t(index)];
+        decodeSegment(index, segment);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            segment.done = true;
+        }
+        m_segmentDone.notify_all();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef OFFLINEDECODER_H
+#define OFFLINEDECODER_H
+
+#include <QString>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "rawcapture.h"
+#include "telemetrysource.h"
+
+/**
+ * @brief Decodes a whole capture file on all cores
+ *
+ * The file is mapped and cut into segments of about SEGMENT_SIZE bytes. A
+ * FRAME_START byte never occurs inside an encoded frame and always resynchronises
+ * FrameDecoder, so a fresh decoder that starts at the first FRAME_START of a
+ * segment is in exactly the state the sequential decoder would be. Each segment
+ * is decoded from there to its end and then on into the following bytes up to
+ * the next FRAME_START, which finishes the frame crossing the boundary; the next
+ * segment's decoder starts at that same byte. The output is identical to
+ * feeding the file through one FrameDecoder.
+ *
+ * Both raw captures (RawCaptureWriter) and plain byte dumps are accepted. For a
+ * raw capture one sequential pass over the record headers finds the segment
+ * boundaries, since records can only be parsed from the start.
+ *
+ * Decoded samples (channel = frame command) reach the sink in file order, in
+ * one samplesReceived() call per segment. At most MAX_SEGMENTS_IN_FLIGHT per
+ * thread are buffered, so memory stays bounded for multi-GB files.
+ */
+class OfflineDecoder
+{
+public:
+    static const qint64 SEGMENT_SIZE = 4 * 1024 * 1024;
+    static const int MAX_SEGMENTS_IN_FLIGHT = 2;
+
+    explicit OfflineDecoder(int threads = 0);
+
+    bool decodeFile(const QString &path, SourceSink &sink);
+    bool decode(const quint8 *data, qint64 size, SourceSink &sink);
+
+    int threadCount() const { return m_threadCount; }
+    quint64 framesDecoded() const { return m_framesDecoded; }
+    quint64 checksumErrors() const { return m_checksumErrors; }
+    quint64 bytesDecoded() const { return m_bytesDecoded; }
+    double throughputBytesPerSecond() const;
+
+private:
+    struct Boundary {
+        qint64 offset;   // Record header (raw capture) or byte offset of the segment
+        qint64 lastNs;   // Reader timestamp before that record
+    };
+
+    struct Segment {
+        std::vector<TelemetrySample> samples;
+        quint64 frames = 0;
+        quint64 checksumErrors = 0;
+        bool done = false;
+    };
+
+    void findBoundaries();
+    void decodeSegment(int index, Segment &segment);
+    void workerLoop();
+
+    int m_threadCount;
+
+    const quint8 *m_data;
+    qint64 m_size;
+    bool m_isCapture;
+    RawCaptureReader m_index;
+    std::vector<Boundary> m_boundaries;
+    std::vector<Segment> m_segments;
+
+    // Work distribution, bounded by what the sink has consumed
+    std::mutex m_mutex;
+    std::condition_variable m_segmentDone;
+    std::condition_variable m_windowMoved;
+    int m_nextSegment;
+    int m_deliveredSegments;
+
+    quint64 m_framesDecoded;
+    quint64 m_checksumErrors;
+    quint64 m_bytesDecoded;
+    qint64 m_elapsedNs;
+};
+
+#endif // OFFLINEDECODER_H
@@ -0,0 +1,275 @@
+#include "pipelineloadtest.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSemaphore>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include "telemetrysource.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+
+namespace {
+// CPU time the calling thread has used, or -1 where the platform cannot tell
+double threadCpuSeconds()
+{
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        return -1.0;
+    const auto ticks = [](const FILETIME &time) {
+        return double((quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime);
+    };
+    return (ticks(kernel) + ticks(user)) * 1e-7;
+#elif defined(Q_OS_UNIX)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return -1.0;
+    return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#else
+    return -1.0;
+#endif
+}
+
+// p in [0, 1] of an unsorted sample, in microseconds
+double percentileUs(std::vector<qint64> &values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    const size_t index = std::min(values.size() - 1, size_t(p * double(values.size())));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return double(values[index]) * 1e-3;
+}
+}
+
+PipelineLoadTest::PipelineLoadTest(double sampleRate, int channels, size_t capacity) :
+    m_sampleRate(sampleRate),
+    m_channels(channels),
+    m_removeRecording(false),
+    m_ring(capacity, SampleRingBuffer::Lossy, channels),
+    m_originNs(0),
+    m_stagesRunning(false),
+    m_decimatedPoints(0),
+    m_elapsed(0.0),
+    m_produced(0),
+    m_acquireCpuSeconds(0.0)
+{
+    m_decimate.name = "decimate";
+    m_record.name = "record";
+}
+
+PipelineLoadTest::~PipelineLoadTest()
+{
+    m_writer.close();
+    if (m_removeRecording)
+        QFile::remove(m_recordPath);
+}
+
+bool PipelineLoadTest::run(double seconds)
+{
+    if (m_recordPath.isEmpty()) {
+        m_recordPath = QDir::temp().filePath(QString("flight-loadtest-%1.ftsf").arg(QCoreApplication::applicationPid()));
+        m_removeRecording = true;
+    }
+    if (m_ring.isNull()) {
+        qWarning() << "Load test: cannot allocate a ring of" << m_ring.capacity() << "samples x" << m_channels << "channels";
+        return false;
+    }
+    if (!m_writer.open(m_recordPath, m_channels, m_sampleRate))
+        return false;
+
+    QTextStream out(stdout);
+    out << QString("Load test: %1 Hz x %2 channels for %3 s, ring of %4 samples, recording to %5")
+               .arg(m_sampleRate).arg(m_channels).arg(seconds).arg(m_ring.capacity()).arg(m_recordPath) << Qt::endl;
+
+    // Readers start at the head, so they must be there before the first sample
+    m_decimate.reader = m_ring.addReader();
+    m_record.reader = m_ring.addReader();
+    m_stagesRunning.store(true, std::memory_order_relaxed);
+    QThread *decimateThread = QThread::create([this]() { decimateLoop(); });
+    QThread *recordThread = QThread::create([this]() { recordLoop(); });
+    decimateThread->start();
+    recordThread->start();
+
+    GeneratorParams params(m_channels);
+    params.sampleRate = m_sampleRate;
+    QThread acquisitionThread;
+    auto worker = new SineWaveWorker(&m_ring);
+    worker->setParams(params);
+    worker->moveToThread(&acquisitionThread);
+    QSemaphore started;
+    QObject::connect(&acquisitionThread, &QThread::started, worker, [this, worker, &started]() {
+        m_originNs.store(HostClock::nowNs(), std::memory_order_release);
+        started.release();
+        worker->start();
+    });
+    QObject::connect(&acquisitionThread, &QThread::finished, worker, [this]() {
+        m_acquireCpuSeconds = threadCpuSeconds();
+    }, Qt::DirectConnection);
+    acquisitionThread.start();
+
+    started.acquire();
+    const qint64 originNs = m_originNs.load(std::memory_order_relaxed);
+    const qint64 endNs = originNs + qint64(seconds * 1e9);
+    for (qint64 nowNs = HostClock::nowNs(); nowNs < endNs; nowNs = HostClock::nowNs()) {
+        QThread::usleep(quint64(std::min<qint64>(endNs - nowNs, 1000000000) / 1000));
+        const double elapsed = double(HostClock::nowNs() - originNs) * 1e-9;
+        out << QString("  %1 s: %2 samples recorded, %3 dropped, ring %4% behind the slowest stage")
+                   .arg(elapsed, 0, 'f', 1)
+                   .arg(m_record.samples.load(std::memory_order_relaxed))
+                   .arg(m_ring.dropped(m_decimate.reader) + m_ring.dropped(m_record.reader))
+                   .arg(m_ring.usage() * 100.0, 0, 'f', 1) << Qt::endl;
+    }
+
+    QMetaObject::invokeMethod(worker, &SineWaveWorker::stop, Qt::BlockingQueuedConnection);
+    m_elapsed = double(HostClock::nowNs() - originNs) * 1e-9;
+    acquisitionThread.quit();
+    acquisitionThread.wait();
+    delete worker;
+
+    // The stages drain what is left, then stop
+    m_stagesRunning.store(false, std::memory_order_release);
+    for (QThread *thread : {decimateThread, recordThread}) {
+        thread->wait();
+        delete thread;
+    }
+    m_decimate.dropped = m_ring.dropped(m_decimate.reader);
+    m_record.dropped = m_ring.dropped(m_record.reader);
+    m_produced = m_record.samples.load(std::memory_order_relaxed) + m_record.dropped;
+    m_writer.close();
+    return true;
+}
+
+qint64 PipelineLoadTest::ageNs(double timestamp) const
+{
+    return HostClock::nowNs() - m_originNs.load(std::memory_order_relaxed) - qint64(timestamp * 1e9);
+}
+
+void PipelineLoadTest::decimateLoop()
+{
+    // The oscilloscope's decimation: minimum and maximum of each display point's bucket
+    MinMaxDecimator decimator;
+    decimator.reset(m_channels, size_t(std::max(1.0, std::ceil(m_sampleRate / DEFAULT_DISPLAY_RATE))));
+    std::vector<const float *> columns(static_cast<size_t>(m_channels));
+
+    for (;;) {
+        const bool running = m_stagesRunning.load(std::memory_order_acquire);
+        const SampleRingBuffer::ReadSpans samples = m_ring.peek(m_decimate.reader, MAX_BATCH);
+        const size_t count = samples.size();
+        if (count == 0) {
+            if (!running)
+                break;
+            m_ring.wait_for(m_decimate.reader, 1, std::chrono::milliseconds(STOP_CHECK_MS));
+            continue;
+        }
+        const double newest = samples[count - 1];
+        m_ringLatencyNs.push_back(ageNs(newest));
+
+        for (int c = 0; c < m_channels; c++)
+            columns[size_t(c)] = m_ring.columnSpans(samples, c).first;
+        decimator.add(samples.first, columns.data(), samples.first_size);
+        for (int c = 0; c < m_channels; c++)
+            columns[size_t(c)] = m_ring.columnSpans(samples, c).second;
+        decimator.add(samples.second, columns.data(), samples.second_size);
+        m_decimatedPoints += decimator.pointCount() * size_t(m_channels);
+        decimator.clearPoints();
+
+        const size_t torn = m_ring.consume(m_decimate.reader, count);
+        m_decimate.samples.fetch_add(count - std::min(torn, count), std::memory_order_relaxed);
+        m_decimate.latencyNs.push_back(ageNs(newest));
+    }
+    m_decimate.cpuSeconds = threadCpuSeconds();
+}
+
+void PipelineLoadTest::recordLoop()
+{
+    // The batch is copied out before consume() so that only intact samples reach the file
+    std::vector<double> times(static_cast<size_t>(MAX_BATCH));
+    std::vector<std::vector<float>> values(static_cast<size_t>(m_channels), std::vector<float>(static_cast<size_t>(MAX_BATCH)));
+    std::vector<const float *> columns(static_cast<size_t>(m_channels));
+
+    for (;;) {
+        const bool running = m_stagesRunning.load(std::memory_order_acquire);
+        const SampleRingBuffer::ReadSpans samples = m_ring.peek(m_record.reader, MAX_BATCH);
+        const size_t count = samples.size();
+        if (count == 0) {
+            if (!running)
+                break;
+            m_ring.wait_for(m_record.reader, 1, std::chrono::milliseconds(STOP_CHECK_MS));
+            continue;
+        }
+
+        std::copy(samples.first, samples.first + samples.first_size, times.begin());
+        std::copy(samples.second, samples.second + samples.second_size, times.begin() + long(samples.first_size));
+        for (int c = 0; c < m_channels; c++) {
+            const RingSpans<const float> column = m_ring.columnSpans(samples, c);
+            std::vector<float> &copy = values[size_t(c)];
+            std::copy(column.first, column.first + column.first_size, copy.begin());
+            std::copy(column.second, column.second + column.second_size, copy.begin() + long(column.first_size));
+        }
+
+        // A lapped range was overwritten from the front while it was copied; the rest is intact
+        const size_t torn = std::min(m_ring.consume(m_record.reader, count), count);
+        for (int c = 0; c < m_channels; c++)
+            columns[size_t(c)] = values[size_t(c)].data() + torn;
+        m_writer.write(times.data() + torn, columns.data(), count - torn);
+        m_record.samples.fetch_add(count - torn, std::memory_order_relaxed);
+        if (torn < count)
+            m_record.latencyNs.push_back(ageNs(times[count - 1]));
+    }
+    m_record.cpuSeconds = threadCpuSeconds();
+}
+
+void PipelineLoadTest::printReport() const
+{
+    QTextStream out(stdout);
+    const double expected = m_sampleRate * m_elapsed;
+    const double recorded = double(m_record.samples.load(std::memory_order_relaxed));
+    const double bytesPerSample = sizeof(double) + sizeof(float) * double(m_channels);
+
+    out << QString("Sustained: %1 samples/s (%2 channel values/s, %3 MB/s recorded) of %4 requested")
+               .arg(recorded / m_elapsed, 0, 'f', 0)
+               .arg(recorded * m_channels / m_elapsed, 0, 'f', 0)
+               .arg(recorded * bytesPerSample / m_elapsed * 1e-6, 0, 'f', 1)
+               .arg(m_sampleRate, 0, 'f', 0) << Qt::endl;
+    out << QString("Produced %1 of %2 due samples (%3 behind schedule), %4 display points")
+               .arg(m_produced)
+               .arg(quint64(expected))
+               .arg(quint64(std::max(0.0, expected - double(m_produced))))
+               .arg(m_decimatedPoints) << Qt::endl;
+    for (const Stage *stage : {&m_decimate, &m_record}) {
+        out << QString("  %1: %2 samples, %3 dropped")
+                   .arg(stage->name, -8)
+                   .arg(stage->samples.load(std::memory_order_relaxed))
+                   .arg(stage->dropped) << Qt::endl;
+    }
+
+    out << QString("Latency (us)  %1 %2 %3 %4 %5 %6")
+               .arg("batches", 9).arg("p50", 9).arg("p90", 9).arg("p99", 9).arg("p99.9", 9).arg("max", 9) << Qt::endl;
+    const std::pair<const char *, const std::vector<qint64> *> latencies[] = {
+        {"ring", &m_ringLatencyNs}, {"decimate", &m_decimate.latencyNs}, {"record", &m_record.latencyNs}};
+    for (const auto &latency : latencies) {
+        std::vector<qint64> values = *latency.second;
+        QString line = QString("  %1  %2").arg(latency.first, -10).arg(values.size(), 9);
+        for (double p : {0.5, 0.9, 0.99, 0.999, 1.0})
+            line += QString(" %1").arg(percentileUs(values, p), 9, 'f', 1);
+        out << line << Qt::endl;
+    }
+
+    out << QString("CPU (s, % of one core over %1 s)").arg(m_elapsed, 0, 'f', 2) << Qt::endl;
+    const std::pair<const char *, double> cpu[] = {
+        {"acquire", m_acquireCpuSeconds}, {"decimate", m_decimate.cpuSeconds}, {"record", m_record.cpuSeconds}};
+    for (const auto &thread : cpu) {
+        out << QString("  %1 %2 %3%")
+                   .arg(thread.first, -10)
+                   .arg(thread.second, 8, 'f', 3)
+                   .arg(thread.second / m_elapsed * 100.0, 6, 'f', 1) << Qt::endl;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef PIPELINELOADTEST_H
+#define PIPELINELOADTEST_H
+
+#include <QString>
+#include <atomic>
+#include <vector>
+#include "minmaxdecimator.h"
+#include "sinewavetest.h"
+
+/**
+ * @brief Headless end-to-end run of the sample pipeline at a given load
+ *
+ * The same stages the oscilloscope runs, without a GUI: SineWaveWorker on its
+ * own thread generates into a lossy SampleRingBuffer, a decimation stage reads
+ * it down to the display rate with MinMaxDecimator and a recorder stage writes
+ * every sample to a sample file, each on its own thread with its own reader
+ * cursor. Both stages drain whatever is there and block in the ring's
+ * wait_for() when it is empty, so the generator's commit wakes them.
+ *
+ * Latency is the age of the newest sample of a batch, from the moment it was
+ * due (its timestamp on the generator's clock) to the moment a stage had it
+ * ("ring", seen by the decimation stage) or was done with it ("decimate",
+ * "record"). It includes the generator's wakeup interval and the stage's wakeup.
+ *
+ * Drops are the samples a stage was lapped on; "behind schedule" counts the
+ * samples that were due but never reached the ring because the generator could
+ * not keep up.
+ *
+ * Progress and the report go to stdout, not through the message handler, so
+ * they show with QT_NO_DEBUG_OUTPUT and can be redirected on their own.
+ */
+class PipelineLoadTest
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 1 << 20;  // samples
+    static const int DEFAULT_DISPLAY_RATE = 150;     // points/sec/channel, as the oscilloscope
+    static const size_t MAX_BATCH = 65536;           // Samples a stage takes at once
+    static const int STOP_CHECK_MS = 10;  // Longest wait before a stage looks whether to stop
+    static constexpr double MAX_SECONDS = 86400.0;
+
+    PipelineLoadTest(double sampleRate, int channels, size_t capacity = DEFAULT_CAPACITY);
+    ~PipelineLoadTest();
+
+    // Record to path instead of a temporary file removed afterwards
+    void setRecordFile(const QString &path) { m_recordPath = path; }
+
+    // Blocks for the run and prints progress once a second; false if it could not start
+    bool run(double seconds);
+    void printReport() const;
+
+private:
+    struct Stage {
+        const char *name;
+        int reader = -1;
+        std::atomic<quint64> samples{0};  // Read intact
+        quint64 dropped = 0;
+        std::vector<qint64> latencyNs;     // One per batch
+        double cpuSeconds = 0.0;
+    };
+
+    void decimateLoop();
+    void recordLoop();
+    qint64 ageNs(double timestamp) const;
+
+    double m_sampleRate;
+    int m_channels;
+    QString m_recordPath;
+    bool m_removeRecording;
+
+    SampleRingBuffer m_ring;
+    std::atomic<qint64> m_originNs;  // HostClock time of the generator's t = 0
+    std::atomic<bool> m_stagesRunning;
+
+    Stage m_decimate;
+    Stage m_record;
+    std::vector<qint64> m_ringLatencyNs;  // Measured by the decimation stage
+    quint64 m_decimatedPoints;
+    SampleFileWriter m_writer;
+
+    double m_elapsed;             // Seconds the generator ran
+    quint64 m_produced;           // Samples that reached the ring
+    double m_acquireCpuSeconds;
+};
+
+#endif // PIPELINELOADTEST_H
@@ -0,0 +1,285 @@
+#include "rawcapture.h"
+#include <QDebug>
+#include <QThread>
+#include <cstring>
+
+RawCaptureWriter::RawCaptureWriter() :
+    m_lastNs(0),
+    m_chunksWritten(0),
+    m_bytesWritten(0)
+{
+}
+
+RawCaptureWriter::~RawCaptureWriter()
+{
+    close();
+}
+
+bool RawCaptureWriter::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "RawCaptureWriter: Cannot open" << path << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer.reserve(size_t(FLUSH_SIZE) + 64 * 1024);
+    m_lastNs = HostClock::nowNs();
+    m_chunksWritten = 0;
+    m_bytesWritten = 0;
+
+    const quint16 version = RAW_CAPTURE_VERSION;
+    const quint16 reserved = 0;
+    quint8 header[RAW_CAPTURE_HEADER_SIZE];
+    memcpy(header, RAW_CAPTURE_MAGIC, 4);
+    memcpy(header + 4, &version, sizeof(version));
+    memcpy(header + 6, &reserved, sizeof(reserved));
+    memcpy(header + 8, &m_lastNs, sizeof(m_lastNs));
+    m_buffer.insert(m_buffer.end(), header, header + RAW_CAPTURE_HEADER_SIZE);
+
+    qDebug() << "RawCaptureWriter: Capturing to" << path;
+    return flush();
+}
+
+void RawCaptureWriter::close()
+{
+    if (!m_file.isOpen())
+        return;
+
+    flush();
+    m_file.close();
+    qDebug() << "RawCaptureWriter: Closed after" << m_chunksWritten << "chunks," << m_bytesWritten << "bytes";
+}
+
+bool RawCaptureWriter::flush()
+{
+    if (m_buffer.empty())
+        return true;
+
+    const qint64 written = m_file.write(reinterpret_cast<const char *>(m_buffer.data()), qint64(m_buffer.size()));
+    m_buffer.clear();
+    return written >= 0;
+}
+
+void RawCaptureWriter::appendVarint(quint64 value)
+{
+    while (value >= 0x80) {
+        m_buffer.push_back(quint8(value | 0x80));
+        value >>= 7;
+    }
+    m_buffer.push_back(quint8(value));
+}
+
+void RawCaptureWriter::chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs)
+{
+    if (!m_file.isOpen() || length <= 0)
+        return;
+
+    // Sources may stamp a chunk slightly before the previous one (kernel vs read time)
+    const qint64 delta = timestampNs > m_lastNs ? timestampNs - m_lastNs : 0;
+    m_lastNs += delta;
+
+    appendVarint(quint64(delta));
+    appendVarint(quint64(length));
+    m_buffer.insert(m_buffer.end(), data, data + length);
+
+    m_chunksWritten++;
+    m_bytesWritten += quint64(length);
+
+    if (m_buffer.size() >= size_t(FLUSH_SIZE))
+        flush();
+}
+
+RawCaptureReader::RawCaptureReader() :
+    m_data(nullptr),
+    m_size(0),
+    m_offset(0),
+    m_startNs(0),
+    m_lastNs(0)
+{
+}
+
+bool RawCaptureReader::attach(const quint8 *data, qint64 size)
+{
+    m_data = nullptr;
+    if (!data || size < RAW_CAPTURE_HEADER_SIZE || memcmp(data, RAW_CAPTURE_MAGIC, 4) != 0)
+        return false;
+
+    quint16 version;
+    memcpy(&version, data + 4, sizeof(version));
+    if (version != RAW_CAPTURE_VERSION)
+        return false;
+
+    m_data = data;
+    m_size = size;
+    memcpy(&m_startNs, data + 8, sizeof(m_startNs));
+    rewind();
+    return true;
+}
+
+void RawCaptureReader::rewind()
+{
+    m_offset = RAW_CAPTURE_HEADER_SIZE;
+    m_lastNs = m_startNs;
+}
+
+void RawCaptureReader::seek(qint64 offset, qint64 lastNs)
+{
+    m_offset = offset;
+    m_lastNs = lastNs;
+}
+
+bool RawCaptureReader::readVarint(const quint8 *data, qint64 size, qint64 &offset, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < size; shift += 7) {
+        const quint8 byte = data[offset++];
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool RawCaptureReader::next(RawCaptureRecord &record)
+{
+    if (!m_data)
+        return false;
+
+    qint64 offset = m_offset;
+    quint64 delta, length;
+    if (!readVarint(m_data, m_size, offset, delta) || !readVarint(m_data, m_size, offset, length))
+        return false;
+    if (length > quint64(m_size - offset))
+        return false;  // Truncated tail of a capture that was still being written
+
+    m_lastNs += qint64(delta);
+    record.timestampNs = m_lastNs;
+    record.data = m_data + offset;
+    record.length = qint64(length);
+    m_offset = offset + qint64(length);
+    return true;
+}
+
+ReplaySource::ReplaySource(const QString &path, double speed, bool loop) :
+    m_path(path),
+    m_speed(speed),
+    m_loop(loop),
+    m_mapped(nullptr),
+    m_hasPending(false),
+    m_atEnd(false),
+    m_replayStartNs(0),
+    m_finishNs(0),
+    m_bytesReplayed(0),
+    m_chunksReplayed(0)
+{
+}
+
+ReplaySource::~ReplaySource()
+{
+    close();
+}
+
+bool ReplaySource::open()
+{
+    if (isOpen())
+        return true;
+
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ReplaySource: Cannot open" << m_path << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_mapped = m_file.map(0, m_file.size());
+    if (!m_mapped || !m_reader.attach(m_mapped, m_file.size())) {
+        qWarning() << "ReplaySource:" << m_path << "is not a raw capture";
+        close();
+        return false;
+    }
+
+    m_hasPending = false;
+    m_atEnd = false;
+    m_bytesReplayed = 0;
+    m_chunksReplayed = 0;
+    m_replayStartNs = HostClock::nowNs();
+
+    qDebug() << "ReplaySource: Replaying" << m_path << "at"
+             << (m_speed > 0.0 ? QString::number(m_speed) + "x" : QString("max speed"));
+    return true;
+}
+
+void ReplaySource::close()
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    m_file.close();
+}
+
+void ReplaySource::finish()
+{
+    m_atEnd = true;
+    m_finishNs = HostClock::nowNs();
+    qDebug() << "ReplaySource: Replayed" << m_chunksReplayed << "chunks," << m_bytesReplayed << "bytes at"
+             << QString::number(throughputBytesPerSecond() / 1e6, 'f', 1) << "MB/s";
+}
+
+double ReplaySource::throughputBytesPerSecond() const
+{
+    const qint64 endNs = m_atEnd ? m_finishNs : HostClock::nowNs();
+    return endNs > m_replayStartNs ? double(m_bytesReplayed) * 1e9 / double(endNs - m_replayStartNs) : 0.0;
+}
+
+qint64 ReplaySource::poll(SourceSink &sink, int timeoutMs)
+{
+    if (!isOpen())
+        return -1;
+
+    if (m_atEnd) {
+        if (!m_loop) {
+            QThread::msleep(quint32(qMax(timeoutMs, 0)));
+            return 0;
+        }
+        m_reader.rewind();
+        m_atEnd = false;
+        m_replayStartNs = HostClock::nowNs();
+    }
+
+    const double scale = m_speed > 0.0 ? 1.0 / m_speed : 1.0;
+    qint64 delivered = 0;
+
+    for (int i = 0; i < MAX_RECORDS_PER_POLL; i++) {
+        if (!m_hasPending) {
+            if (!m_reader.next(m_pending)) {
+                finish();
+                break;
+            }
+            m_hasPending = true;
+        }
+
+        const qint64 dueNs = m_replayStartNs + qint64(double(m_pending.timestampNs - m_reader.startNs()) * scale);
+        if (m_speed > 0.0) {
+            // Records due within the slack go out now, stamped with their due time
+            const qint64 waitNs = dueNs - HostClock::nowNs();
+            if (waitNs > PACING_SLACK_NS) {
+                // Nothing delivered yet: sleep towards the next record within the timeout
+                if (delivered == 0 && timeoutMs > 0)
+                    QThread::usleep(quint64(qMin<qint64>(waitNs / 1000, qint64(timeoutMs) * 1000)));
+                break;
+            }
+        }
+
+        sink.chunkReceived(m_pending.data, m_pending.length, dueNs);
+        m_hasPending = false;
+        delivered += m_pending.length;
+        m_bytesReplayed += quint64(m_pending.length);
+        m_chunksReplayed++;
+    }
+
+    return delivered;
+}
@@ -0,0 +1,138 @@
+#ifndef RAWCAPTURE_H
+#define RAWCAPTURE_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "telemetrysource.h"
+
+/**
+ * Raw capture file layout (little-endian):
+ *
+ *   header:  "FTRC" | u16 version | u16 reserved | i64 startNs
+ *   record:  varint deltaNs | varint length | length bytes
+ *
+ * deltaNs is the host monotonic time since the previous record (the first one is
+ * relative to startNs), so a record header is usually 2-4 bytes.
+ */
+#define RAW_CAPTURE_MAGIC        "FTRC"
+#define RAW_CAPTURE_VERSION      1
+#define RAW_CAPTURE_HEADER_SIZE  16
+
+struct RawCaptureRecord {
+    qint64 timestampNs;     // Host monotonic time the chunk was received
+    const quint8 *data;
+    qint64 length;
+};
+
+/**
+ * @brief Sink that logs every received chunk into a raw capture file
+ *
+ * Chunks are appended to an in-memory buffer and written out in large blocks, so
+ * the reader thread does one write() per FLUSH_SIZE bytes.
+ */
+class RawCaptureWriter : public SourceSink
+{
+public:
+    static const int FLUSH_SIZE = 256 * 1024;
+
+    RawCaptureWriter();
+    ~RawCaptureWriter() override;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    bool flush();
+
+    void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) override;
+
+    quint64 chunksWritten() const { return m_chunksWritten; }
+    quint64 bytesWritten() const { return m_bytesWritten; }
+
+private:
+    void appendVarint(quint64 value);
+
+    QFile m_file;
+    std::vector<quint8> m_buffer;
+    qint64 m_lastNs;
+    quint64 m_chunksWritten;
+    quint64 m_bytesWritten;
+};
+
+/**
+ * @brief Sequential reader over an in-memory or mapped raw capture
+ */
+class RawCaptureReader
+{
+public:
+    RawCaptureReader();
+
+    // data must hold the whole file including the header
+    bool attach(const quint8 *data, qint64 size);
+    bool next(RawCaptureRecord &record);
+    void rewind();
+    // Continue from a record boundary previously seen at offset() with lastNs()
+    void seek(qint64 offset, qint64 lastNs);
+
+    qint64 startNs() const { return m_startNs; }
+    qint64 offset() const { return m_offset; }
+    qint64 lastNs() const { return m_lastNs; }
+    qint64 size() const { return m_size; }
+
+    static bool readVarint(const quint8 *data, qint64 size, qint64 &offset, quint64 &value);
+
+private:
+    const quint8 *m_data;
+    qint64 m_size;
+    qint64 m_offset;
+    qint64 m_startNs;
+    qint64 m_lastNs;
+};
+
+/**
+ * @brief Feeds a raw capture back through the normal decoder path
+ *
+ * speed 1.0 replays in real time, N replays N times faster and 0 replays as fast
+ * as the consumer can take it (use that as an end-to-end throughput benchmark).
+ * Timestamps keep the captured spacing, scaled by speed, starting at open().
+ */
+class ReplaySource : public TelemetrySource
+{
+public:
+    static const int MAX_RECORDS_PER_POLL = 1024;
+    static const qint64 PACING_SLACK_NS = 1000000;  // Sleeping for less is dominated by wakeup cost
+
+    explicit ReplaySource(const QString &path, double speed = 1.0, bool loop = false);
+    ~ReplaySource() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_mapped != nullptr; }
+    qint64 poll(SourceSink &sink, int timeoutMs) override;
+
+    bool atEnd() const { return m_atEnd; }
+    double throughputBytesPerSecond() const;
+    quint64 bytesReplayed() const { return m_bytesReplayed; }
+    quint64 chunksReplayed() const { return m_chunksReplayed; }
+
+private:
+    void finish();
+
+    QString m_path;
+    double m_speed;
+    bool m_loop;
+
+    QFile m_file;
+    uchar *m_mapped;
+    RawCaptureReader m_reader;
+    RawCaptureRecord m_pending;
+    bool m_hasPending;
+    bool m_atEnd;
+
+    qint64 m_replayStartNs;
+    qint64 m_finishNs;
+    quint64 m_bytesReplayed;
+    quint64 m_chunksReplayed;
+};
+
+#endif // RAWCAPTURE_H
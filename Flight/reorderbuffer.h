@@ -0,0 +1,112 @@
+#ifndef REORDERBUFFER_H
+#define REORDERBUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "telemetrysource.h"
+
+/**
+ * @brief Bounded-latency reorder buffer merging several links onto one timeline
+ *
+ * Samples are held in a min-heap on timestampNs and released once they are older
+ * than now - maxLatency, so every released sample is at most maxLatency behind
+ * real time and links whose data arrives up to maxLatency late still interleave
+ * in timestamp order. Samples that arrive later than that are still delivered
+ * (per-link order is preserved) but counted as late. When the heap is full the
+ * oldest sample is released early instead of growing the storage.
+ *
+ * Single-threaded: owned by the merging consumer.
+ */
+class ReorderBuffer
+{
+public:
+    explicit ReorderBuffer(qint64 maxLatencyNs = 50000000, size_t capacity = 65536) :
+        m_maxLatencyNs(maxLatencyNs),
+        m_capacity(capacity),
+        m_watermarkNs(0),
+        m_sequence(0),
+        m_lateSamples(0),
+        m_overflowReleases(0)
+    {
+        m_heap.reserve(capacity);
+    }
+
+    template<typename Emit>
+    void insert(const TelemetrySample &sample, Emit &&emit)
+    {
+        if (sample.timestampNs < m_watermarkNs)
+            m_lateSamples++;
+
+        if (m_heap.size() >= m_capacity) {
+            m_overflowReleases++;
+            emit(popOldest());
+        }
+
+        m_heap.push_back(Entry{sample, m_sequence++});
+        std::push_heap(m_heap.begin(), m_heap.end(), Later());
+    }
+
+    // Release every sample that has waited out the latency bound
+    template<typename Emit>
+    size_t release(qint64 nowNs, Emit &&emit)
+    {
+        const qint64 horizonNs = nowNs - m_maxLatencyNs;
+        size_t released = 0;
+        while (!m_heap.empty() && m_heap.front().sample.timestampNs <= horizonNs) {
+            emit(popOldest());
+            released++;
+        }
+        return released;
+    }
+
+    template<typename Emit>
+    void flush(Emit &&emit)
+    {
+        while (!m_heap.empty())
+            emit(popOldest());
+    }
+
+    void setMaxLatencyNs(qint64 maxLatencyNs) { m_maxLatencyNs = maxLatencyNs; }
+    qint64 maxLatencyNs() const { return m_maxLatencyNs; }
+    size_t size() const { return m_heap.size(); }
+    quint64 lateSamples() const { return m_lateSamples; }
+    quint64 overflowReleases() const { return m_overflowReleases; }
+
+private:
+    // Samples of one chunk share a timestamp; the sequence keeps them in arrival order
+    struct Entry {
+        TelemetrySample sample;
+        quint64 sequence;
+    };
+
+    struct Later {
+        bool operator()(const Entry &a, const Entry &b) const
+        {
+            if (a.sample.timestampNs != b.sample.timestampNs)
+                return a.sample.timestampNs > b.sample.timestampNs;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    TelemetrySample popOldest()
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+        TelemetrySample sample = m_heap.back().sample;
+        m_heap.pop_back();
+        if (sample.timestampNs > m_watermarkNs)
+            m_watermarkNs = sample.timestampNs;
+        return sample;
+    }
+
+    std::vector<Entry> m_heap;
+    qint64 m_maxLatencyNs;
+    size_t m_capacity;
+    qint64 m_watermarkNs;  // Newest timestamp released so far
+    quint64 m_sequence;
+
+    quint64 m_lateSamples;
+    quint64 m_overflowReleases;
+};
+
+#endif // REORDERBUFFER_H
@@ -0,0 +1,241 @@
+#include "samplefile.h"
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+SampleFileWriter::SampleFileWriter() :
+    m_samplesWritten(0)
+{
+}
+
+SampleFileWriter::~SampleFileWriter()
+{
+    close();
+}
+
+bool SampleFileWriter::open(const QString &path, int channels, double sampleRate)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "SampleFileWriter: Cannot open" << path << ":" << m_file.errorString();
+        return false;
+    }
+
+    m_timestamps.clear();
+    m_timestamps.reserve(BLOCK_SAMPLES);
+    m_columns.assign(size_t(channels), std::vector<float>());
+    for (std::vector<float> &column : m_columns)
+        column.reserve(BLOCK_SAMPLES);
+    m_samplesWritten = 0;
+
+    const quint16 version = SAMPLE_FILE_VERSION;
+    const quint16 channelCount = quint16(channels);
+    const quint64 reserved = 0;
+    char header[SAMPLE_FILE_HEADER_SIZE];
+    memcpy(header, SAMPLE_FILE_MAGIC, 4);
+    memcpy(header + 4, &version, sizeof(version));
+    memcpy(header + 6, &channelCount, sizeof(channelCount));
+    memcpy(header + 8, &sampleRate, sizeof(sampleRate));
+    memcpy(header + 16, &reserved, sizeof(reserved));
+    if (m_file.write(header, SAMPLE_FILE_HEADER_SIZE) != SAMPLE_FILE_HEADER_SIZE) {
+        qWarning() << "SampleFileWriter: Cannot write" << path << ":" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    qDebug() << "SampleFileWriter: Recording" << channels << "channels at" << sampleRate << "Hz to" << path;
+    return true;
+}
+
+void SampleFileWriter::close()
+{
+    if (!m_file.isOpen())
+        return;
+
+    flush();
+    m_file.close();
+    qDebug() << "SampleFileWriter: Closed after" << m_samplesWritten << "samples";
+}
+
+void SampleFileWriter::write(const double *t, const float *const *y, size_t count)
+{
+    if (!m_file.isOpen())
+        return;
+
+    for (size_t done = 0; done < count;) {
+        const size_t n = std::min(count - done, BLOCK_SAMPLES - m_timestamps.size());
+        m_timestamps.insert(m_timestamps.end(), t + done, t + done + n);
+        for (size_t c = 0; c < m_columns.size(); c++)
+            m_columns[c].insert(m_columns[c].end(), y[c] + done, y[c] + done + n);
+        done += n;
+
+        if (m_timestamps.size() == size_t(BLOCK_SAMPLES))
+            flush();
+    }
+}
+
+bool SampleFileWriter::flush()
+{
+    if (m_timestamps.empty())
+        return true;
+
+    // A short write is an error: the rest of the block would land out of place
+    const auto writeAll = [this](const void *data, size_t length) {
+        return m_file.write(static_cast<const char *>(data), qint64(length)) == qint64(length);
+    };
+    const quint32 header[2] = {quint32(m_timestamps.size()), 0};
+    bool ok = writeAll(header, sizeof(header));
+    ok = ok && writeAll(m_timestamps.data(), m_timestamps.size() * sizeof(double));
+    for (const std::vector<float> &column : m_columns)
+        ok = ok && writeAll(column.data(), column.size() * sizeof(float));
+
+    if (ok) {
+        m_samplesWritten += m_timestamps.size();
+    } else {
+        // Stop here; readers leave out the truncated last block
+        qWarning() << "SampleFileWriter: Cannot write" << m_file.fileName() << ":" << m_file.errorString()
+                   << ", recording stopped after" << m_samplesWritten << "samples";
+        m_file.close();
+    }
+    m_timestamps.clear();
+    for (std::vector<float> &column : m_columns)
+        column.clear();
+    return ok;
+}
+
+SampleFileReader::SampleFileReader() :
+    m_mapped(nullptr),
+    m_channels(0),
+    m_sampleRate(0.0),
+    m_sampleCount(0),
+    m_firstTimestamp(0.0),
+    m_duration(0.0),
+    m_block(0),
+    m_offset(0)
+{
+}
+
+SampleFileReader::~SampleFileReader()
+{
+    close();
+}
+
+bool SampleFileReader::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SampleFileReader: Cannot open" << path << ":" << m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    m_mapped = size >= SAMPLE_FILE_HEADER_SIZE ? m_file.map(0, size) : nullptr;
+    quint16 version = 0;
+    quint16 channels = 0;
+    if (m_mapped) {
+        memcpy(&version, m_mapped + 4, sizeof(version));
+        memcpy(&channels, m_mapped + 6, sizeof(channels));
+        memcpy(&m_sampleRate, m_mapped + 8, sizeof(m_sampleRate));
+    }
+    if (!m_mapped || memcmp(m_mapped, SAMPLE_FILE_MAGIC, 4) != 0 || version != SAMPLE_FILE_VERSION
+        || channels == 0 || !(m_sampleRate > 0.0)) {
+        qWarning() << "SampleFileReader:" << path << "is not a sample file";
+        close();
+        return false;
+    }
+    m_channels = channels;
+
+    // Index the blocks; a truncated last block (a recording cut short) is left out
+    const size_t bytesPerSample = sizeof(double) + sizeof(float) * size_t(m_channels);
+    qint64 offset = SAMPLE_FILE_HEADER_SIZE;
+    while (size - offset >= SAMPLE_FILE_BLOCK_HEADER_SIZE) {
+        quint32 count;
+        memcpy(&count, m_mapped + offset, sizeof(count));
+        const qint64 end = offset + SAMPLE_FILE_BLOCK_HEADER_SIZE + qint64(count * bytesPerSample);
+        if (count == 0 || end > size)
+            break;
+        const uchar *timestamps = m_mapped + offset + SAMPLE_FILE_BLOCK_HEADER_SIZE;
+        m_blocks.push_back({timestamps, timestamps + count * sizeof(double), count});
+        m_sampleCount += count;
+        offset = end;
+    }
+    if (m_blocks.empty()) {
+        qWarning() << "SampleFileReader:" << path << "holds no samples";
+        close();
+        return false;
+    }
+
+    double last;
+    const Block &lastBlock = m_blocks.back();
+    memcpy(&m_firstTimestamp, m_blocks.front().timestamps, sizeof(double));
+    memcpy(&last, lastBlock.timestamps + (lastBlock.count - 1) * sizeof(double), sizeof(double));
+    m_duration = last - m_firstTimestamp + 1.0 / m_sampleRate;
+    rewind();
+
+    qDebug() << "SampleFileReader:" << path << "holds" << m_sampleCount << "samples x" << m_channels
+             << "channels at" << m_sampleRate << "Hz (" << m_duration << "s)";
+    return true;
+}
+
+void SampleFileReader::close()
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    m_file.close();
+    m_blocks.clear();
+    m_channels = 0;
+    m_sampleCount = 0;
+    m_block = 0;
+    m_offset = 0;
+}
+
+void SampleFileReader::rewind()
+{
+    m_block = 0;
+    m_offset = 0;
+}
+
+size_t SampleFileReader::read(double *t, float *const *y, int columns, size_t count)
+{
+    const int channels = std::min(columns, m_channels);
+    size_t done = 0;
+    while (done < count && !atEnd()) {
+        const Block &block = m_blocks[m_block];
+        const size_t n = std::min(count - done, block.count - m_offset);
+
+        memcpy(t + done, block.timestamps + m_offset * sizeof(double), n * sizeof(double));
+        for (int c = 0; c < channels; c++) {
+            const uchar *column = block.columns + size_t(c) * block.count * sizeof(float);
+            memcpy(y[c] + done, column + m_offset * sizeof(float), n * sizeof(float));
+        }
+
+        done += n;
+        m_offset += n;
+        if (m_offset == block.count) {
+            m_block++;
+            m_offset = 0;
+        }
+    }
+    return done;
+}
+
+size_t SampleFileReader::skip(size_t count)
+{
+    size_t done = 0;
+    while (done < count && !atEnd()) {
+        const size_t n = std::min(count - done, m_blocks[m_block].count - m_offset);
+        done += n;
+        m_offset += n;
+        if (m_offset == m_blocks[m_block].count) {
+            m_block++;
+            m_offset = 0;
+        }
+    }
+    return done;
+}
@@ -0,0 +1,103 @@
+#ifndef SAMPLEFILE_H
+#define SAMPLEFILE_H
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Sample file layout (little-endian), the columnar form of a sample stream:
+ *
+ *   header:  "FTSF" | u16 version | u16 channels | f64 sampleRate | u64 reserved
+ *   block:   u32 count | u32 reserved | count f64 timestamps | count f32 per channel, channel 0 first
+ *
+ * Timestamps are in seconds. A block holds up to BLOCK_SAMPLES samples, so a
+ * column is copied with one memcpy and a reader steps over blocks by their header.
+ */
+#define SAMPLE_FILE_MAGIC              "FTSF"
+#define SAMPLE_FILE_VERSION            1
+#define SAMPLE_FILE_HEADER_SIZE        24
+#define SAMPLE_FILE_BLOCK_HEADER_SIZE  8
+
+/**
+ * @brief Records a sample stream into a sample file, one block per BLOCK_SAMPLES samples
+ */
+class SampleFileWriter
+{
+public:
+    static const int BLOCK_SAMPLES = 65536;
+
+    SampleFileWriter();
+    ~SampleFileWriter();
+
+    bool open(const QString &path, int channels, double sampleRate);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // y holds channels() arrays of count values
+    void write(const double *t, const float *const *y, size_t count);
+    // Write out the pending samples as a (short) block
+    bool flush();
+
+    int channels() const { return int(m_columns.size()); }
+    quint64 samplesWritten() const { return m_samplesWritten; }
+
+private:
+    QFile m_file;
+    std::vector<double> m_timestamps;
+    std::vector<std::vector<float>> m_columns;
+    quint64 m_samplesWritten;
+};
+
+/**
+ * @brief Sequential reader over a mapped sample file
+ *
+ * The blocks are indexed at open(), so skip() and the end of the file are
+ * found without touching the samples.
+ */
+class SampleFileReader
+{
+public:
+    SampleFileReader();
+    ~SampleFileReader();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_mapped != nullptr; }
+
+    int channels() const { return m_channels; }
+    double sampleRate() const { return m_sampleRate; }
+    quint64 sampleCount() const { return m_sampleCount; }
+    double firstTimestamp() const { return m_firstTimestamp; }
+    // From the first timestamp to one sample period past the last
+    double duration() const { return m_duration; }
+
+    // Copy the next count samples or as many as are left; y holds an array for
+    // each of the first columns channels, up to channels()
+    size_t read(double *t, float *const *y, int columns, size_t count);
+    size_t skip(size_t count);
+    void rewind();
+    bool atEnd() const { return m_block >= m_blocks.size(); }
+
+private:
+    struct Block {
+        const uchar *timestamps;
+        const uchar *columns;
+        size_t count;
+    };
+
+    QFile m_file;
+    uchar *m_mapped;
+    std::vector<Block> m_blocks;
+    int m_channels;
+    double m_sampleRate;
+    quint64 m_sampleCount;
+    double m_firstTimestamp;
+    double m_duration;
+
+    size_t m_block;   // Current block
+    size_t m_offset;  // Next sample in it
+};
+
+#endif // SAMPLEFILE_H
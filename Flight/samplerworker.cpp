@@ -7,24 +7,45 @@
 #include <QtMath>
 #include <QtCore/QRandomGenerator>
 #include "samplerworker.h"
+#include "udpsource.h"
+#include "iiosource.h"
+#include "serialsource.h"
 
 
 
-SamplerWorker::SamplerWorker(QQueue<QPointF> *samplesQueue, QObject *parent) :
-    QObject(parent)
+SamplerWorker::SamplerWorker(SampleRing *samples, QObject *parent) :
+    QObject(parent),
+    m_droppedSamples(0)
 {
     _working = false;
     _abort = false;
-    m_SamplesQueue = samplesQueue;
-    m_adcFile.setFileName("/sys/bus/iio/devices/iio:device0/in_voltage1_raw");
+    m_samples = samples;
+    m_adcSource = new IioSource(IIO_DEFAULT_DEVICE, QStringList() << IIO_DEFAULT_CHANNEL);
+    m_adcUnavailable = false;
     m_dataSource = DATASOURCE_ADC;
+    m_requestedSource.store(DATASOURCE_ADC);
     m_refreshPoints = 10;
     m_index = -1;
+    m_serialSource = new SerialSource(SERIAL_DEFAULT_PORT);
+    m_serialLowLatency = false;
+    m_serialModeChanged = false;
+    m_probeSequence = 0;
+    m_probeSentNs = 0;
+    m_nextProbeNs = 0;
+    m_lastChunkNs = 0;
+    m_nextStatsNs = 0;
+    m_udpSource = new UdpSource(UDP_TELEMETRY_PORT);
+    m_replaySource = nullptr;
+    m_captureChanged = false;
+    m_decoder.setFrameHandler([this](const DecodedFrame &frame) { frameDecoded(frame); });
 }
 
 SamplerWorker::~SamplerWorker()
 {
-
+    delete m_adcSource;
+    delete m_udpSource;
+    delete m_replaySource;
+    delete m_serialSource;
 }
 
 void SamplerWorker::requestWork()
@@ -48,15 +69,88 @@ void SamplerWorker::abort()
     mutex.unlock();
 }
 
+void SamplerWorker::setCaptureFile(const QString &path)
+{
+    // Applied by the worker thread, which owns the capture writer
+    mutex.lock();
+    m_capturePath = path;
+    m_captureChanged = true;
+    mutex.unlock();
+}
+
+void SamplerWorker::setReplayFile(const QString &path, double speed)
+{
+    // Call before requestWork(); the replay source is owned by the worker thread
+    delete m_replaySource;
+    m_replaySource = new ReplaySource(path, speed);
+}
+
+void SamplerWorker::setSerialPort(const QString &portName)
+{
+    // Call before requestWork(); the port is opened by the worker thread
+    delete m_serialSource;
+    m_serialSource = new SerialSource(portName);
+}
+
+void SamplerWorker::setSerialLowLatency(bool enabled)
+{
+    // Applied by the worker thread, which reopens the port in the new mode
+    mutex.lock();
+    m_serialLowLatency = enabled;
+    m_serialModeChanged = true;
+    mutex.unlock();
+}
+
 void SamplerWorker::setSource(int source)
 {
+    // Only a request: the worker thread performs the handover between two polls
+    m_requestedSource.store(source, std::memory_order_release);
+}
+
+TelemetrySource *SamplerWorker::sourceFor(int dataSource) const
+{
+    switch(dataSource)
+    {
+    case DATASOURCE_ADC:    return m_adcSource;
+    case DATASOURCE_SERIAL: return m_serialSource;
+    case DATASOURCE_UDP:    return m_udpSource;
+    case DATASOURCE_REPLAY: return m_replaySource;
+    default:                return nullptr;     // Sine generator
+    }
+}
+
+void SamplerWorker::switchSource(int source)
+{
+    TelemetrySource *outgoing = sourceFor(m_dataSource);
+    TelemetrySource *incoming = sourceFor(source);
+
+    // Open the new source first so it is already buffering while the old one drains
+    if(incoming && incoming != outgoing && !incoming->isOpen())
+        incoming->open();
+
+    if(outgoing && outgoing != incoming && outgoing->isOpen())
+    {
+        for(int i = 0; i < SOURCE_DRAIN_POLLS && outgoing->poll(*this, 0) > 0; i++)
+            ;
+        if(m_dataSource == DATASOURCE_SERIAL)
+            logLinkStats();
+        outgoing->close();
+    }
+
+    // A frame cut short by the switch must not be completed by bytes of the new stream.
+    // m_index keeps counting so the plot scrolls on without a jump.
+    m_decoder.reset();
+    m_linkStats.reset();
+    m_probeSentNs = 0;
+    m_nextStatsNs = HostClock::nowNs() + LINK_STATS_INTERVAL_NS;
+    m_adcUnavailable = false;
+
+    qDebug() << "Data source switched from" << m_dataSource << "to" << source;
     m_dataSource = source;
-    if(source == DATASOURCE_ADC)
+    if(source == DATASOURCE_ADC || source == DATASOURCE_UDP || source == DATASOURCE_REPLAY)
         m_refreshPoints = 100;
     else
         m_refreshPoints = 10;
-    m_index = -1;
-    m_SamplesQueue->clear();
 }
 
 void SamplerWorker::doWork()
@@ -64,57 +158,104 @@ void SamplerWorker::doWork()
     qDebug()<<"Starting worker process in Thread "<<thread()->currentThreadId();
 
     bool abort = false;
-    qreal x = 0;
     qreal y = 0;
-    int yValue = 0;
-
-
-    quint8 inByte;
-    int numByte = 0;
-    int receiverStatus = RCV_ST_IDLE;
-    Frame *m_inFrame = nullptr;
-    quint8 checksum = 0, xored = 0x00;
-    int dataLength = 0;
-
-    // Serial Port Initialization
-    m_Serial = new QSerialPort();
-    m_Serial->setPortName("ttyUSB0");
-    m_Serial->setBaudRate(QSerialPort::Baud115200);
-    m_Serial->setDataBits(QSerialPort::Data8);
-    m_Serial->setParity(QSerialPort::NoParity);
-    m_Serial->setStopBits(QSerialPort::OneStop);
-    m_Serial->setFlowControl(QSerialPort::NoFlowControl);
-    m_Serial->open(QIODevice::ReadWrite);
-    qDebug() << "SerialPort Status: " << m_Serial->isOpen();
-
 
     while(!abort)
     {
+        QString capturePath;
+        bool captureChanged;
+        bool serialLowLatency;
+        bool serialModeChanged;
         mutex.lock();
         abort = _abort;
+        capturePath = m_capturePath;
+        captureChanged = m_captureChanged;
+        m_captureChanged = false;
+        serialLowLatency = m_serialLowLatency;
+        serialModeChanged = m_serialModeChanged;
+        m_serialModeChanged = false;
         mutex.unlock();
 
+        if(serialModeChanged)
+        {
+            // Log the figures of the old mode so both can be compared
+            logLinkStats();
+            m_serialSource->close();
+            m_serialSource->setLowLatency(serialLowLatency);
+        }
+
+        if(captureChanged)
+        {
+            if(capturePath.isEmpty())
+                m_capture.close();
+            else
+                m_capture.open(capturePath);
+        }
+
+        const int requestedSource = m_requestedSource.load(std::memory_order_acquire);
+        if(requestedSource != m_dataSource)
+            switchSource(requestedSource);
+
+        if(m_dataSource == DATASOURCE_REPLAY && m_replaySource)
+        {
+            if(!m_replaySource->isOpen() && !m_replaySource->open())
+            {
+                QThread::msleep(100);
+                continue;
+            }
+            m_replaySource->poll(*this, 10);
+            continue;
+        }
+
+        if(m_dataSource == DATASOURCE_SERIAL)
+        {
+            pollSerial();
+            continue;
+        }
+
+        if(m_dataSource == DATASOURCE_UDP)
+        {
+            // Datagrams are decoded in chunkReceived(), samples appended per frame
+            if(!m_udpSource->isOpen() && !m_udpSource->open())
+            {
+                QThread::msleep(100);
+                continue;
+            }
+            m_udpSource->poll(*this, 10);
+            continue;
+        }
+
+        if(m_dataSource == DATASOURCE_ADC && !m_adcUnavailable)
+        {
+            // Buffered capture delivers whole blocks of scans to samplesReceived()
+            if(m_adcSource->isOpen() || m_adcSource->open())
+            {
+                m_adcSource->poll(*this, 10);
+                continue;
+            }
+            qWarning() << "ADC capture unavailable, falling back to the test sine wave";
+            m_adcUnavailable = true;
+        }
+
         QThread::usleep(100);
                                        // READ DATA FROM SERIAL
 
-        if(++m_index >= 2100)
-            m_SamplesQueue->dequeue();
-
         // Generate 5Hz sine wave for testing
         // Sampling rate: 10kHz, frequency: 5Hz
         // Time = m_index / 10000.0 seconds
-        qreal time = m_index / 10000.0;
+        qreal time = (m_index + 1) / 10000.0;
         y = 5.0 * qSin(2.0 * M_PI * 50.0 * time); // 5Hz sine wave with amplitude 100
-        x = qreal(m_index);
-        m_SamplesQueue->enqueue(QPointF(x, y));
-        qDebug() << "sine wave "<<x<<" "<<y<<" m_index "<<m_index;
-        if((m_index % m_refreshPoints) == 0)
-        {
-            emit updateCurve();
-            qDebug() << "update Curve";
-        }
+        appendSample(y);
     }
 
+    logLinkStats();
+    m_serialSource->close();
+    m_udpSource->close();
+    m_adcSource->close();
+    if(m_replaySource)
+        m_replaySource->close();
+    m_capture.close();
+
     // Set _working to false, meaning the process can't be aborted anymore.
     mutex.lock();
     _working = false;
@@ -126,3 +267,98 @@ void SamplerWorker::doWork()
 }
 
 
+
+void SamplerWorker::pollSerial()
+{
+    if(!m_serialSource->isOpen())
+    {
+        if(!m_serialSource->open())
+        {
+            QThread::msleep(100);
+            return;
+        }
+        m_linkStats.reset();
+        m_probeSentNs = 0;
+        m_nextStatsNs = HostClock::nowNs() + LINK_STATS_INTERVAL_NS;
+    }
+
+    // One probe in flight at a time; its echo is matched in frameDecoded(). It goes
+    // out only while the link is idle, so it neither waits behind nor delays a burst.
+    const qint64 nowNs = HostClock::nowNs();
+    if(nowNs >= m_nextProbeNs && nowNs - m_lastChunkNs >= SERIAL_PROBE_IDLE_NS
+       && (m_probeSentNs == 0 || nowNs - m_probeSentNs > SERIAL_PROBE_TIMEOUT_NS))
+    {
+        Frame probe;
+        probe.AddByte(Frame::FRAME_START);
+        probe.AddByte(CMD_PING);
+        probe.AddByte(4);
+        m_probeSequence++;
+        for(int shift = 24; shift >= 0; shift -= 8)
+            probe.AddByte(quint8(m_probeSequence >> shift));
+        probe.AddByte(probe.CalculateChecksum());
+        m_probeSentNs = HostClock::nowNs();
+        if(m_serialSource->write(probe.GetEscapedBuffer()) < 0)
+            m_probeSentNs = 0;
+        m_nextProbeNs = nowNs + SERIAL_PROBE_INTERVAL_NS;
+    }
+
+    if(m_serialSource->poll(*this, 10) < 0)
+    {
+        qWarning() << "Serial link" << m_serialSource->portName() << "lost, reopening";
+        logLinkStats();
+        m_serialSource->close();
+        return;
+    }
+
+    if(nowNs >= m_nextStatsNs)
+    {
+        logLinkStats();
+        m_nextStatsNs = nowNs + LINK_STATS_INTERVAL_NS;
+    }
+}
+
+void SamplerWorker::logLinkStats()
+{
+    if(!m_serialSource->isOpen() || m_linkStats.chunks() == 0)
+        return;
+
+    qDebug().noquote() << "Serial" << m_serialSource->portName()
+                       << (m_serialSource->lowLatencyActive() ? "[low-latency]:" : "[default]:")
+                       << m_linkStats.summary();
+}
+
+void SamplerWorker::chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs)
+{
+    m_lastChunkNs = timestampNs;
+    m_linkStats.chunkArrived(timestampNs);
+    if(m_capture.isOpen())
+        m_capture.chunkReceived(data, length, timestampNs);
+    m_decoder.feed(data, length, timestampNs);
+}
+
+void SamplerWorker::samplesReceived(const TelemetrySample *samples, int count)
+{
+    for(int i = 0; i < count; i++)
+        appendSample(qreal(samples[i].value));
+}
+
+void SamplerWorker::frameDecoded(const DecodedFrame &frame)
+{
+    if(frame.cmd == CMD_ADC_INPUT)
+        appendSample(qreal(frame.value()));
+    else if(frame.cmd == CMD_PING && m_probeSentNs != 0 && frame.value() == m_probeSequence)
+    {
+        m_linkStats.rttMeasured(frame.timestampNs - m_probeSentNs);
+        m_probeSentNs = 0;
+    }
+}
+
+void SamplerWorker::appendSample(qreal y)
+{
+    // Never blocks: if the GUI falls that far behind, the newest points are dropped
+    if(!m_samples->push(QPointF(qreal(++m_index), y)))
+        m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+
+    if((m_index % m_refreshPoints) == 0)
+        emit updateCurve();
+}
@@ -3,10 +3,14 @@
 
 #include <QObject>
 #include <QMutex>
-#include <QtSerialPort/QSerialPort>
-#include <QQueue>
-#include <QFile>
+#include <QPointF>
+#include <atomic>
+#include "RingBuffer.h"
 #include "frame.h"
+#include "framedecoder.h"
+#include "linkstats.h"
+#include "rawcapture.h"
+#include "telemetrysource.h"
 
 #define CMD_BUTTON_1             1    //  ESP32 -> RPI        BUTTON 1 STATUS (PRESSED, UNPRESSED)
 #define CMD_BUTTON_2             2    //  ESP32 -> RPI        BUTTON 2 STATUS (PRESSED, UNPRESSED)
@@ -16,33 +20,80 @@
 #define CMD_PWM_LED_B            6    //  RPI -> ESP32        SET PWM DUTYCYCLE FOR BLUE LED (0 - 255)
 #define CMD_ADC_INPUT            7    //  ESP32 -> RPI        ADC READ VALUE (0 - 4095)
 #define CMD_ADC_ENABLE           8    //  RPI -> ESP32        ENABLE/DISABLE ADC READING/
+#define CMD_PING                 9    //  RPI -> ESP32 -> RPI ECHOED LATENCY PROBE (SEQUENCE NUMBER)
 
 #define DATASOURCE_ADC      0
 #define DATASOURCE_SERIAL   1
+#define DATASOURCE_UDP      2
+#define DATASOURCE_REPLAY   3
+#define DATASOURCE_SINE     4
 
-class SamplerWorker : public QObject
+#define SOURCE_DRAIN_POLLS  16      // Bound on zero-timeout polls that drain the outgoing source
+
+#define SERIAL_DEFAULT_PORT         "ttyUSB0"
+#define SERIAL_PROBE_INTERVAL_NS    100000000LL     // Latency probe every 100 ms
+#define SERIAL_PROBE_TIMEOUT_NS     1000000000LL    // Unanswered probes are given up after 1 s
+#define SERIAL_PROBE_IDLE_NS        2000000LL       // Probe only after 2 ms without received bytes
+#define LINK_STATS_INTERVAL_NS      5000000000LL
+
+class UdpSource;
+class IioSource;
+class SerialSource;
+
+#define SAMPLE_RING_SIZE    16384   // About 1.6 s of the 10 kHz test signal between two GUI updates
+
+class SamplerWorker : public QObject, public SourceSink
 {
     Q_OBJECT
 public:
-    explicit SamplerWorker(QQueue<QPointF> *samplesQueue, QObject *parent = nullptr);
+    // Producer: the worker thread. Consumer: DataSource on the GUI thread
+    typedef RingBuffer<QPointF, SAMPLE_RING_SIZE> SampleRing;
+
+    explicit SamplerWorker(SampleRing *samples, QObject *parent = nullptr);
     ~SamplerWorker();
     void requestWork();
     void abort();
+    void setCaptureFile(const QString &path);
+    void setReplayFile(const QString &path, double speed);
+    void setSerialPort(const QString &portName);
+
+    void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) override;
+    void samplesReceived(const TelemetrySample *samples, int count) override;
+
+    quint64 droppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
 
 private:
-    static const int RCV_ST_IDLE = 0;
-    static const int RCV_ST_CMD = 1;
-    static const int RCV_ST_DATA_LENGTH = 2;
-    static const int RCV_ST_DATA = 3;
-    static const int RCV_ST_CHECKSUM = 4;
+    void frameDecoded(const DecodedFrame &frame);
+    void appendSample(qreal y);
+    TelemetrySource *sourceFor(int dataSource) const;
+    void switchSource(int source);
+    void pollSerial();
+    void logLinkStats();
 
     bool _abort;
     bool _working;
     QMutex mutex;
-    QQueue<QPointF> *m_SamplesQueue;
-    QFile m_adcFile;
-    QSerialPort *m_Serial;
-    int m_dataSource;
+    SampleRing *m_samples;
+    std::atomic<quint64> m_droppedSamples;
+    IioSource *m_adcSource;
+    bool m_adcUnavailable;
+    SerialSource *m_serialSource;
+    bool m_serialLowLatency;
+    bool m_serialModeChanged;
+    LinkStats m_linkStats;
+    quint32 m_probeSequence;
+    qint64 m_probeSentNs;
+    qint64 m_nextProbeNs;
+    qint64 m_lastChunkNs;
+    qint64 m_nextStatsNs;
+    UdpSource *m_udpSource;
+    ReplaySource *m_replaySource;
+    RawCaptureWriter m_capture;
+    QString m_capturePath;
+    bool m_captureChanged;
+    FrameDecoder m_decoder;
+    int m_dataSource;                       // Worker thread only
+    std::atomic<int> m_requestedSource;     // Written by setSource() from any thread
     int m_refreshPoints;
     int m_index;
 
@@ -56,6 +107,7 @@ signals:
 public slots:
     void doWork();
     void setSource(int source);
+    void setSerialLowLatency(bool enabled);
 };
 
 #endif // SAMPLERWORKER_H
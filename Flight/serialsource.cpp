@@ -0,0 +1,208 @@
+#include "serialsource.h"
+#include <QDebug>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+SerialSource::SerialSource(const QString &portName, qint32 baudRate) :
+    m_portName(portName),
+    m_baudRate(baudRate),
+    m_serial(nullptr),
+    m_lowLatency(false),
+    m_lowLatencyActive(false),
+    m_serialFlagsSaved(false),
+    m_savedSerialFlags(0)
+{
+}
+
+SerialSource::~SerialSource()
+{
+    close();
+}
+
+bool SerialSource::open()
+{
+    if (isOpen())
+        return true;
+
+    // Created here so the port lives in the thread that polls it
+    if (!m_serial)
+        m_serial = new QSerialPort();
+
+    m_serial->setPortName(m_portName);
+    m_serial->setBaudRate(m_baudRate);
+    m_serial->setDataBits(QSerialPort::Data8);
+    m_serial->setParity(QSerialPort::NoParity);
+    m_serial->setStopBits(QSerialPort::OneStop);
+    m_serial->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_serial->open(QIODevice::ReadWrite)) {
+        qWarning() << "SerialSource: Cannot open" << m_portName << ":" << m_serial->errorString();
+        return false;
+    }
+
+    m_readBuffer.resize(READ_BUFFER_SIZE);
+    m_lowLatencyActive = m_lowLatency && applyLowLatency();
+    qDebug() << "SerialSource: Opened" << m_portName << "at" << m_baudRate << "baud,"
+             << (m_lowLatencyActive ? "low-latency" : "default") << "mode, latency timer" << latencyTimer();
+    return true;
+}
+
+void SerialSource::close()
+{
+    if (m_serial) {
+        if (m_serial->isOpen()) {
+            restoreSerialFlags();
+            m_serial->close();
+        }
+        delete m_serial;
+        m_serial = nullptr;
+    }
+    m_lowLatencyActive = false;
+}
+
+bool SerialSource::isOpen() const
+{
+    return m_serial && m_serial->isOpen();
+}
+
+int SerialSource::handle() const
+{
+#ifdef Q_OS_UNIX
+    return isOpen() ? int(m_serial->handle()) : -1;
+#else
+    return -1;
+#endif
+}
+
+bool SerialSource::applyLowLatency()
+{
+#ifdef Q_OS_LINUX
+    const int fd = handle();
+    if (fd < 0)
+        return false;
+
+    struct serial_struct serial;
+    if (::ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        m_savedSerialFlags = serial.flags;
+        m_serialFlagsSaved = true;
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (::ioctl(fd, TIOCSSERIAL, &serial) < 0)
+            qWarning() << "SerialSource: ASYNC_LOW_LATENCY rejected by driver:" << strerror(errno);
+    } else {
+        qWarning() << "SerialSource: TIOCGSERIAL unsupported on" << m_portName;
+    }
+    return true;
+#else
+    qWarning() << "SerialSource: Low-latency mode is only available on Linux";
+    return false;
+#endif
+}
+
+void SerialSource::restoreSerialFlags()
+{
+#ifdef Q_OS_LINUX
+    // ASYNC_LOW_LATENCY outlives the file descriptor; leave the tty as it was found
+    const int fd = handle();
+    struct serial_struct serial;
+    if (m_serialFlagsSaved && fd >= 0 && ::ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags = m_savedSerialFlags;
+        ::ioctl(fd, TIOCSSERIAL, &serial);
+    }
+#endif
+    m_serialFlagsSaved = false;
+}
+
+QString SerialSource::latencyTimer() const
+{
+    // Exposed by ftdi_sio; other drivers have no such timer
+    QFile file(QString("/sys/bus/usb-serial/devices/%1/latency_timer").arg(m_portName.section('/', -1)));
+    if (!file.open(QIODevice::ReadOnly))
+        return QString("n/a");
+    return QString::fromLatin1(file.readAll()).trimmed() + " ms";
+}
+
+qint64 SerialSource::write(const QByteArray &data)
+{
+    if (!isOpen())
+        return -1;
+
+#ifdef Q_OS_LINUX
+    if (m_lowLatencyActive)
+        return ::write(handle(), data.constData(), size_t(data.size()));
+#endif
+    const qint64 written = m_serial->write(data);
+    m_serial->waitForBytesWritten(100);
+    return written;
+}
+
+qint64 SerialSource::poll(SourceSink &sink, int timeoutMs)
+{
+    if (!isOpen())
+        return -1;
+
+    if (m_lowLatencyActive)
+        return pollLowLatency(sink, timeoutMs);
+
+    if (m_serial->bytesAvailable() == 0 && !m_serial->waitForReadyRead(timeoutMs)) {
+        const bool timedOut = m_serial->error() == QSerialPort::TimeoutError;
+        m_serial->clearError();
+        return timedOut ? 0 : -1;
+    }
+
+    const qint64 timestampNs = HostClock::nowNs();
+    qint64 total = 0;
+    qint64 n;
+    while ((n = m_serial->read(m_readBuffer.data(), m_readBuffer.size())) > 0) {
+        sink.chunkReceived(reinterpret_cast<const quint8 *>(m_readBuffer.constData()), n, timestampNs);
+        total += n;
+    }
+    return n < 0 ? -1 : total;
+}
+
+qint64 SerialSource::pollLowLatency(SourceSink &sink, int timeoutMs)
+{
+#ifdef Q_OS_LINUX
+    const int fd = handle();
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    const int rv = ::poll(&pfd, 1, timeoutMs);
+    if (rv <= 0)
+        return (rv < 0 && errno != EINTR) ? -1 : 0;
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        return -1;
+
+    const qint64 timestampNs = HostClock::nowNs();
+
+    // Size the read to what the driver holds, so a burst is one syscall and a
+    // single byte is not held back waiting for a buffer to fill
+    int queued = 0;
+    if (::ioctl(fd, FIONREAD, &queued) < 0 || queued <= 0)
+        queued = READ_BUFFER_SIZE;
+    if (queued > m_readBuffer.size())
+        m_readBuffer.resize(qMin(queued, int(MAX_READ_BUFFER_SIZE)));
+
+    const ssize_t n = ::read(fd, m_readBuffer.data(), size_t(qMin(queued, int(m_readBuffer.size()))));
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    if (n == 0)
+        return -1;  // Adapter unplugged
+
+    sink.chunkReceived(reinterpret_cast<const quint8 *>(m_readBuffer.constData()), n, timestampNs);
+    return n;
+#else
+    Q_UNUSED(sink);
+    Q_UNUSED(timeoutMs);
+    return -1;
+#endif
+}
@@ -0,0 +1,66 @@
+#ifndef SERIALSOURCE_H
+#define SERIALSOURCE_H
+
+#include <QString>
+#include <QtSerialPort/QSerialPort>
+#include "telemetrysource.h"
+
+/**
+ * @brief Serial-port telemetry source
+ *
+ * Used from a worker thread without an event loop: poll() waits with
+ * waitForReadyRead() and reads into a buffer allocated once in open().
+ *
+ * Low-latency mode (Linux) removes the buffering between the adapter and the
+ * decoder: ASYNC_LOW_LATENCY is set on the tty (FTDI and similar drivers drop
+ * their latency timer from 16 ms to 1 ms), and poll() waits on the descriptor
+ * directly and reads exactly what the driver has queued (FIONREAD) in one call,
+ * bypassing QSerialPort's internal buffer. The descriptor is non-blocking, as
+ * QSerialPort opens it, so termios VMIN/VTIME would have no effect and are left
+ * alone. The previous serial flags are restored on close().
+ */
+class SerialSource : public TelemetrySource
+{
+public:
+    static const int READ_BUFFER_SIZE = 4096;
+    static const int MAX_READ_BUFFER_SIZE = 65536;   // Low-latency reads grow up to this
+
+    explicit SerialSource(const QString &portName,
+                          qint32 baudRate = QSerialPort::Baud115200);
+    ~SerialSource() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+    qint64 poll(SourceSink &sink, int timeoutMs) override;
+    int handle() const override;
+
+    // Takes effect on the next open()
+    void setLowLatency(bool enabled) { m_lowLatency = enabled; }
+    bool lowLatency() const { return m_lowLatency; }
+    bool lowLatencyActive() const { return m_lowLatencyActive; }
+
+    // Blocking write for commands and latency probes
+    qint64 write(const QByteArray &data);
+
+    QSerialPort *port() const { return m_serial; }
+    QString portName() const { return m_portName; }
+
+private:
+    bool applyLowLatency();
+    void restoreSerialFlags();
+    qint64 pollLowLatency(SourceSink &sink, int timeoutMs);
+    QString latencyTimer() const;
+
+    QString m_portName;
+    qint32 m_baudRate;
+    QSerialPort *m_serial;
+    QByteArray m_readBuffer;
+
+    bool m_lowLatency;
+    bool m_lowLatencyActive;
+    bool m_serialFlagsSaved;
+    int m_savedSerialFlags;
+};
+
+#endif // SERIALSOURCE_H
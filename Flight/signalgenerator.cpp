@@ -0,0 +1,666 @@
+#include "signalgenerator.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const double TWO_PI = 6.283185307179586;
+const float ZIGGURAT_R = 3.442619855899f;  // Start of the tail
+const uint32_t ZIGGURAT_LAYER_MASK = 127;
+
+// Four 32-bit lanes, integer (U32x4) or float (F32x4)
+#if defined(__SSE2__)
+typedef __m128i U32x4;
+typedef __m128 F32x4;
+
+inline U32x4 loadU(const uint32_t *p) { return _mm_load_si128(reinterpret_cast<const __m128i *>(p)); }
+inline void storeU(uint32_t *p, U32x4 v) { _mm_store_si128(reinterpret_cast<__m128i *>(p), v); }
+inline U32x4 setU(uint32_t v) { return _mm_set1_epi32(int(v)); }
+inline U32x4 addU(U32x4 a, U32x4 b) { return _mm_add_epi32(a, b); }
+inline U32x4 xorU(U32x4 a, U32x4 b) { return _mm_xor_si128(a, b); }
+inline U32x4 andU(U32x4 a, U32x4 b) { return _mm_and_si128(a, b); }
+template<int N> inline U32x4 shlU(U32x4 a) { return _mm_slli_epi32(a, N); }
+template<int N> inline U32x4 rotlU(U32x4 a) { return _mm_or_si128(_mm_slli_epi32(a, N), _mm_srli_epi32(a, 32 - N)); }
+inline U32x4 absS(U32x4 a) { const __m128i sign = _mm_srai_epi32(a, 31); return _mm_sub_epi32(_mm_xor_si128(a, sign), sign); }
+inline U32x4 lessS(U32x4 a, U32x4 b) { return _mm_cmplt_epi32(a, b); }
+inline int laneMask(U32x4 m) { return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+inline U32x4 gatherU(const uint32_t *table, const uint32_t *index)
+{
+    return _mm_setr_epi32(int(table[index[0]]), int(table[index[1]]), int(table[index[2]]), int(table[index[3]]));
+}
+
+inline F32x4 loadF(const float *p) { return _mm_loadu_ps(p); }
+inline void storeF(float *p, F32x4 v) { _mm_storeu_ps(p, v); }
+inline F32x4 setF(float v) { return _mm_set1_ps(v); }
+inline F32x4 addF(F32x4 a, F32x4 b) { return _mm_add_ps(a, b); }
+inline F32x4 subF(F32x4 a, F32x4 b) { return _mm_sub_ps(a, b); }
+inline F32x4 mulF(F32x4 a, F32x4 b) { return _mm_mul_ps(a, b); }
+inline F32x4 toF(U32x4 a) { return _mm_cvtepi32_ps(a); }  // Lanes as signed
+inline U32x4 truncU(F32x4 a) { return _mm_cvttps_epi32(a); }
+inline F32x4 absF(F32x4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline F32x4 selectLess(F32x4 a, F32x4 b, F32x4 ifLess, F32x4 otherwise)
+{
+    const __m128 less = _mm_cmplt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(less, ifLess), _mm_andnot_ps(less, otherwise));
+}
+inline F32x4 gatherF(const float *table, const uint32_t *index)
+{
+    return _mm_setr_ps(table[index[0]], table[index[1]], table[index[2]], table[index[3]]);
+}
+#elif defined(__ARM_NEON)
+typedef uint32x4_t U32x4;
+typedef float32x4_t F32x4;
+
+inline U32x4 loadU(const uint32_t *p) { return vld1q_u32(p); }
+inline void storeU(uint32_t *p, U32x4 v) { vst1q_u32(p, v); }
+inline U32x4 setU(uint32_t v) { return vdupq_n_u32(v); }
+inline U32x4 addU(U32x4 a, U32x4 b) { return vaddq_u32(a, b); }
+inline U32x4 xorU(U32x4 a, U32x4 b) { return veorq_u32(a, b); }
+inline U32x4 andU(U32x4 a, U32x4 b) { return vandq_u32(a, b); }
+template<int N> inline U32x4 shlU(U32x4 a) { return vshlq_n_u32(a, N); }
+template<int N> inline U32x4 rotlU(U32x4 a) { return vorrq_u32(vshlq_n_u32(a, N), vshrq_n_u32(a, 32 - N)); }
+inline U32x4 absS(U32x4 a) { return vreinterpretq_u32_s32(vabsq_s32(vreinterpretq_s32_u32(a))); }
+inline U32x4 lessS(U32x4 a, U32x4 b) { return vcltq_s32(vreinterpretq_s32_u32(a), vreinterpretq_s32_u32(b)); }
+inline int laneMask(U32x4 m)
+{
+    const uint32_t bits[4] = {1, 2, 4, 8};
+    const uint32x4_t masked = vandq_u32(m, vld1q_u32(bits));
+    return int(vgetq_lane_u32(masked, 0) | vgetq_lane_u32(masked, 1) | vgetq_lane_u32(masked, 2) | vgetq_lane_u32(masked, 3));
+}
+inline U32x4 gatherU(const uint32_t *table, const uint32_t *index)
+{
+    const uint32_t v[4] = {table[index[0]], table[index[1]], table[index[2]], table[index[3]]};
+    return vld1q_u32(v);
+}
+
+inline F32x4 loadF(const float *p) { return vld1q_f32(p); }
+inline void storeF(float *p, F32x4 v) { vst1q_f32(p, v); }
+inline F32x4 setF(float v) { return vdupq_n_f32(v); }
+inline F32x4 addF(F32x4 a, F32x4 b) { return vaddq_f32(a, b); }
+inline F32x4 subF(F32x4 a, F32x4 b) { return vsubq_f32(a, b); }
+inline F32x4 mulF(F32x4 a, F32x4 b) { return vmulq_f32(a, b); }
+inline F32x4 toF(U32x4 a) { return vcvtq_f32_s32(vreinterpretq_s32_u32(a)); }
+inline U32x4 truncU(F32x4 a) { return vreinterpretq_u32_s32(vcvtq_s32_f32(a)); }
+inline F32x4 absF(F32x4 a) { return vabsq_f32(a); }
+inline F32x4 selectLess(F32x4 a, F32x4 b, F32x4 ifLess, F32x4 otherwise) { return vbslq_f32(vcltq_f32(a, b), ifLess, otherwise); }
+inline F32x4 gatherF(const float *table, const uint32_t *index)
+{
+    const float v[4] = {table[index[0]], table[index[1]], table[index[2]], table[index[3]]};
+    return vld1q_f32(v);
+}
+#else
+struct U32x4 { uint32_t v[4]; };
+struct F32x4 { float v[4]; };
+
+#define LANEWISE(T, expr) T r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r
+inline U32x4 loadU(const uint32_t *p) { LANEWISE(U32x4, p[i]); }
+inline void storeU(uint32_t *p, U32x4 v) { for (int i = 0; i < 4; i++) p[i] = v.v[i]; }
+inline U32x4 setU(uint32_t v) { LANEWISE(U32x4, v); }
+inline U32x4 addU(U32x4 a, U32x4 b) { LANEWISE(U32x4, a.v[i] + b.v[i]); }
+inline U32x4 xorU(U32x4 a, U32x4 b) { LANEWISE(U32x4, a.v[i] ^ b.v[i]); }
+inline U32x4 andU(U32x4 a, U32x4 b) { LANEWISE(U32x4, a.v[i] & b.v[i]); }
+template<int N> inline U32x4 shlU(U32x4 a) { LANEWISE(U32x4, a.v[i] << N); }
+template<int N> inline U32x4 rotlU(U32x4 a) { LANEWISE(U32x4, (a.v[i] << N) | (a.v[i] >> (32 - N))); }
+inline U32x4 absS(U32x4 a) { LANEWISE(U32x4, int32_t(a.v[i]) < 0 ? 0u - a.v[i] : a.v[i]); }
+inline U32x4 lessS(U32x4 a, U32x4 b) { LANEWISE(U32x4, int32_t(a.v[i]) < int32_t(b.v[i]) ? ~0u : 0u); }
+inline int laneMask(U32x4 m) { return int((m.v[0] & 1) | (m.v[1] & 2) | (m.v[2] & 4) | (m.v[3] & 8)); }
+inline U32x4 gatherU(const uint32_t *table, const uint32_t *index) { LANEWISE(U32x4, table[index[i]]); }
+
+inline F32x4 loadF(const float *p) { LANEWISE(F32x4, p[i]); }
+inline void storeF(float *p, F32x4 v) { for (int i = 0; i < 4; i++) p[i] = v.v[i]; }
+inline F32x4 setF(float v) { LANEWISE(F32x4, v); }
+inline F32x4 addF(F32x4 a, F32x4 b) { LANEWISE(F32x4, a.v[i] + b.v[i]); }
+inline F32x4 subF(F32x4 a, F32x4 b) { LANEWISE(F32x4, a.v[i] - b.v[i]); }
+inline F32x4 mulF(F32x4 a, F32x4 b) { LANEWISE(F32x4, a.v[i] * b.v[i]); }
+inline F32x4 toF(U32x4 a) { LANEWISE(F32x4, float(int32_t(a.v[i]))); }
+inline U32x4 truncU(F32x4 a) { LANEWISE(U32x4, uint32_t(int32_t(a.v[i]))); }
+inline F32x4 absF(F32x4 a) { LANEWISE(F32x4, std::fabs(a.v[i])); }
+inline F32x4 selectLess(F32x4 a, F32x4 b, F32x4 ifLess, F32x4 otherwise) { LANEWISE(F32x4, a.v[i] < b.v[i] ? ifLess.v[i] : otherwise.v[i]); }
+inline F32x4 gatherF(const float *table, const uint32_t *index) { LANEWISE(F32x4, table[index[i]]); }
+#undef LANEWISE
+#endif
+
+inline F32x4 fracF(F32x4 a) { return subF(a, toF(truncU(a))); }  // a >= 0
+
+inline void rotate(F32x4 &re, F32x4 &im, F32x4 byRe, F32x4 byIm)
+{
+    const F32x4 nextRe = subF(mulF(re, byRe), mulF(im, byIm));
+    im = addF(mulF(re, byIm), mulF(im, byRe));
+    re = nextRe;
+}
+
+// Layer boundaries of the 128-layer Ziggurat, for 32-bit signed random words
+struct ZigguratTables {
+    uint32_t k[128];  // |word| below k[i]: inside layer i's rectangle
+    float w[128];     // Word to x scale of layer i
+    float f[128];     // exp(-x²/2) at the layer edges
+
+    ZigguratTables()
+    {
+        const double m1 = 2147483648.0;
+        const double vn = 9.91256303526217e-3;
+        double dn = ZIGGURAT_R;
+        double tn = dn;
+        const double q = vn / std::exp(-0.5 * dn * dn);
+
+        k[0] = uint32_t(dn / q * m1);
+        k[1] = 0;
+        w[0] = float(q / m1);
+        w[127] = float(dn / m1);
+        f[0] = 1.0f;
+        f[127] = float(std::exp(-0.5 * dn * dn));
+        for (int i = 126; i >= 1; i--) {
+            dn = std::sqrt(-2.0 * std::log(vn / dn + std::exp(-0.5 * dn * dn)));
+            k[i + 1] = uint32_t(dn / tn * m1);
+            tn = dn;
+            f[i] = float(std::exp(-0.5 * dn * dn));
+            w[i] = float(dn / m1);
+        }
+    }
+};
+
+const ZigguratTables &ziggurat()
+{
+    static const ZigguratTables tables;
+    return tables;
+}
+
+// PRBS-15 (x^15 + x^14 + 1, ITU-T O.150) as ±1 chips
+const uint32_t PRBS_LENGTH = 32767;
+
+struct PrbsTable {
+    float chip[PRBS_LENGTH];
+
+    PrbsTable()
+    {
+        uint32_t lfsr = 0x7fff;
+        for (uint32_t i = 0; i < PRBS_LENGTH; i++) {
+            const uint32_t bit = ((lfsr >> 14) ^ (lfsr >> 13)) & 1;
+            lfsr = ((lfsr << 1) | bit) & 0x7fff;
+            chip[i] = bit ? 1.0f : -1.0f;
+        }
+    }
+};
+
+const PrbsTable &prbs()
+{
+    static const PrbsTable table;
+    return table;
+}
+
+uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline uint32_t rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/*
+ * Unit sine of a + b m + c m² cycles at samples m = 0 .. count - 1, four phasors
+ * one sample apart. Each is rotated by the phase of its next four samples, and
+ * for a chirp (c != 0) that step itself turns by 32 c cycles per iteration.
+ * Writes count rounded up to a multiple of 4.
+ */
+void oscillator(float *shape, size_t count, double a, double b, double c)
+{
+    alignas(16) float re[4], im[4], stepRe[4], stepIm[4];
+    for (int lane = 0; lane < 4; lane++) {
+        const double m = lane;
+        double cycles = a + b * m + c * m * m;
+        cycles -= std::floor(cycles);
+        re[lane] = float(std::cos(TWO_PI * cycles));
+        im[lane] = float(std::sin(TWO_PI * cycles));
+        double step = 4.0 * b + c * (8.0 * m + 16.0);
+        step -= std::floor(step);
+        stepRe[lane] = float(std::cos(TWO_PI * step));
+        stepIm[lane] = float(std::sin(TWO_PI * step));
+    }
+    F32x4 phasorRe = loadF(re);
+    F32x4 phasorIm = loadF(im);
+    F32x4 byRe = loadF(stepRe);
+    F32x4 byIm = loadF(stepIm);
+
+    if (c == 0.0) {
+        for (size_t i = 0; i < count; i += 4) {
+            storeF(shape + i, phasorIm);
+            rotate(phasorRe, phasorIm, byRe, byIm);
+        }
+        return;
+    }
+
+    double turn = 32.0 * c;
+    turn -= std::floor(turn);
+    const F32x4 turnRe = setF(float(std::cos(TWO_PI * turn)));
+    const F32x4 turnIm = setF(float(std::sin(TWO_PI * turn)));
+    for (size_t i = 0; i < count; i += 4) {
+        storeF(shape + i, phasorIm);
+        rotate(phasorRe, phasorIm, byRe, byIm);
+        rotate(byRe, byIm, turnRe, turnIm);
+    }
+}
+
+/*
+ * shape(x, previous x) four samples at a time, x = 1 + fraction + m * step being
+ * sample m's cycle count since the block's first whole cycle, plus one (so the
+ * previous sample's stays positive too). Same rounding for every use of an m.
+ * Writes count rounded up to a multiple of 4.
+ */
+template<typename Shape>
+void cycleShape(float *out, size_t count, double fraction, double step, Shape shape)
+{
+    alignas(16) static const float laneIndex[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const F32x4 start = setF(float(1.0 + fraction));
+    const F32x4 stepV = setF(float(step));
+    const F32x4 one = setF(1.0f);
+    const F32x4 four = setF(4.0f);
+    F32x4 m = loadF(laneIndex);
+
+    for (size_t i = 0; i < count; i += 4) {
+        const F32x4 x = addF(start, mulF(m, stepV));
+        const F32x4 previous = addF(start, mulF(subF(m, one), stepV));
+        storeF(out + i, shape(x, previous));
+        m = addF(m, four);
+    }
+}
+
+// xoshiro128++ step on four lanes
+inline U32x4 nextWords(U32x4 &s0, U32x4 &s1, U32x4 &s2, U32x4 &s3)
+{
+    const U32x4 result = addU(rotlU<7>(addU(s0, s3)), s0);
+    const U32x4 t = shlU<9>(s1);
+    s2 = xorU(s2, s0);
+    s3 = xorU(s3, s1);
+    s1 = xorU(s1, s2);
+    s0 = xorU(s0, s3);
+    s2 = xorU(s2, t);
+    s3 = rotlU<11>(s3);
+    return result;
+}
+
+}
+
+SignalGenerator::SignalGenerator(uint64_t seed) :
+    m_position(0),
+    m_originPosition(0),
+    m_originTime(0.0)
+{
+    ziggurat();  // Build the tables outside the first generate()
+    prbs();
+    this->seed(seed);
+    resetOrigins();
+}
+
+void SignalGenerator::setParams(const GeneratorParams &params)
+{
+    const bool rateChanged = params.sampleRate != m_params.sampleRate;
+    const size_t kept = std::min(params.channels.size(), m_params.channels.size());
+    const double now = time();
+    double whole, fraction;
+
+    // Channels whose frequency, sweep or rate changes count on from their cycles
+    // at position(), under the old parameters
+    for (size_t c = 0; c < kept; c++) {
+        const ChannelParams &from = m_params.channels[c];
+        const ChannelParams &to = params.channels[c];
+        Sweep fromSweep, toSweep;
+        const bool wasSweep = sweepOf(from, fromSweep);
+        const bool isSweep = sweepOf(to, toSweep);
+
+        if (isSweep && !wasSweep) {
+            // Periods on the plain grid, as if it had always swept
+            m_channelOrigins[c] = {0, 0.0, 0.0, 0.0, 0.0};
+        } else if (isSweep) {
+            const bool sweepChanged = to.waveform != from.waveform || to.frequency != from.frequency
+                || to.sweepFrequency != from.sweepFrequency || to.sweepTime != from.sweepTime
+                || to.burstCycles != from.burstCycles || to.burstPeriod != from.burstPeriod;
+            if (rateChanged || sweepChanged) {
+                const double start = periodStart(int(c), fromSweep.period, now);
+                const double cycles = sweepCycles(int(c), fromSweep, m_position, start, now - start);
+                m_channelOrigins[c] = {m_position, std::floor(cycles), cycles - std::floor(cycles), start, now - start};
+            }
+        } else if (wasSweep) {
+            const double cycles = to.frequency * now;
+            m_channelOrigins[c] = {m_position, std::floor(cycles), cycles - std::floor(cycles), 0.0, 0.0};
+        } else if (rateChanged || to.frequency != from.frequency) {
+            cyclesAt(int(c), 0.0, whole, fraction);
+            m_channelOrigins[c] = {m_position, whole, fraction, 0.0, 0.0};
+        }
+    }
+    if (rateChanged) {
+        m_originTime = time();
+        m_originPosition = m_position;
+    }
+
+    // New channels start as if they had always run: f * time()
+    m_channelOrigins.resize(params.channels.size());
+    for (size_t c = kept; c < params.channels.size(); c++) {
+        const double cycles = params.channels[c].frequency * now;
+        m_channelOrigins[c] = {m_position, std::floor(cycles), cycles - std::floor(cycles), 0.0, 0.0};
+    }
+    m_params = params;
+}
+
+void SignalGenerator::seek(uint64_t position)
+{
+    m_position = position;
+    m_originPosition = 0;
+    m_originTime = 0.0;
+    resetOrigins();
+}
+
+void SignalGenerator::resetOrigins()
+{
+    m_channelOrigins.assign(m_params.channels.size(), ChannelOrigin{0, 0.0, 0.0, 0.0, 0.0});
+}
+
+void SignalGenerator::seed(uint64_t seed)
+{
+    m_seed = seed;
+    uint64_t state = seed;
+    for (int word = 0; word < 4; word++) {
+        for (int lane = 0; lane < 4; lane += 2) {
+            const uint64_t bits = splitMix64(state);
+            m_state[word][lane] = uint32_t(bits);
+            m_state[word][lane + 1] = uint32_t(bits >> 32);
+        }
+    }
+    for (int word = 0; word < 4; word += 2) {
+        const uint64_t bits = splitMix64(state);
+        m_scalarState[word] = uint32_t(bits);
+        m_scalarState[word + 1] = uint32_t(bits >> 32);
+    }
+}
+
+void SignalGenerator::generate(double *t, float *const *y, size_t count)
+{
+    for (size_t done = 0; done < count;) {
+        const size_t n = std::min(count - done, BLOCK_SIZE);
+
+        if (t) {
+            // Deterministic timestamp: t = k/Fs, from where the sample rate last changed
+            const uint64_t first = m_position - m_originPosition;
+            for (size_t i = 0; i < n; i++)
+                t[done + i] = m_originTime + double(first + i) / m_params.sampleRate;
+        }
+        for (int ch = 0; ch < m_params.channelCount(); ch++)
+            generateChannel(ch, y[ch] + done, n);
+
+        m_position += n;
+        done += n;
+    }
+}
+
+void SignalGenerator::generateChannel(int channel, float *out, size_t count)
+{
+    const ChannelParams &params = m_params.channels[size_t(channel)];
+    const double cyclesPerSample = params.frequency / m_params.sampleRate;
+    const double phase = params.phase / 360.0;
+    double whole, fraction;
+
+    // The noise goes into out first and the waveform is added onto it
+    const bool noisy = params.noiseLevel != 0.0;
+    if (noisy)
+        gaussian(out, count);
+
+    const F32x4 plusOne = setF(1.0f);
+    const F32x4 minusOne = setF(-1.0f);
+    switch (params.waveform) {
+    case ChannelParams::Sine:
+        cyclesAt(channel, phase, whole, fraction);
+        oscillator(m_shape, count, fraction, cyclesPerSample, 0.0);
+        break;
+    case ChannelParams::Square: {
+        const F32x4 duty = setF(float(params.duty));
+        cyclesAt(channel, phase, whole, fraction);
+        cycleShape(m_shape, count, fraction, cyclesPerSample, [&](F32x4 x, F32x4) {
+            return selectLess(fracF(x), duty, plusOne, minusOne);
+        });
+        break;
+    }
+    case ChannelParams::Triangle: {
+        // Quarter of a cycle ahead: rising through 0 at phase 0, like the sine
+        const F32x4 half = setF(0.5f);
+        const F32x4 four = setF(4.0f);
+        cyclesAt(channel, phase + 0.25, whole, fraction);
+        cycleShape(m_shape, count, fraction, cyclesPerSample, [&](F32x4 x, F32x4) {
+            return subF(plusOne, mulF(four, absF(subF(fracF(x), half))));
+        });
+        break;
+    }
+    case ChannelParams::Impulse:
+        // 1 where the whole cycle count moved on since the previous sample
+        cyclesAt(channel, phase, whole, fraction);
+        cycleShape(m_shape, count, fraction, cyclesPerSample, [](F32x4 x, F32x4 previous) {
+            return subF(toF(truncU(x)), toF(truncU(previous)));
+        });
+        break;
+    case ChannelParams::Prbs: {
+        // Chip x - 1 of the block's first whole cycle, each channel at its own offset of the sequence
+        const float *chips = prbs().chip;
+        uint64_t state = m_seed + uint64_t(channel) * 0x9e3779b97f4a7c15ULL;
+        cyclesAt(channel, phase, whole, fraction);
+        const uint32_t base = uint32_t((uint64_t(whole) + splitMix64(state) + PRBS_LENGTH - 1) % PRBS_LENGTH);
+        alignas(16) uint32_t index[4];
+        cycleShape(m_shape, count, fraction, cyclesPerSample, [&](F32x4 x, F32x4) {
+            storeU(index, truncU(x));
+            for (int lane = 0; lane < 4; lane++)
+                index[lane] = (base + index[lane]) % PRBS_LENGTH;
+            return gatherF(chips, index);
+        });
+        break;
+    }
+    case ChannelParams::Step: {
+        const double before = std::ceil((params.stepTime - time()) * m_params.sampleRate);
+        const size_t edge = size_t(std::clamp(before, 0.0, double(count)));
+        std::fill(m_shape, m_shape + edge, 0.0f);
+        std::fill(m_shape + edge, m_shape + count, 1.0f);
+        break;
+    }
+    case ChannelParams::Chirp:
+    case ChannelParams::Burst:
+        periodicOscillator(channel, m_shape, count);
+        break;
+    }
+
+    const F32x4 dc = setF(float(params.dc));
+    const F32x4 amplitude = setF(float(params.amplitude));
+    const F32x4 noiseLevel = setF(float(params.noiseLevel));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        F32x4 value = addF(dc, mulF(amplitude, loadF(m_shape + i)));
+        if (noisy)
+            value = addF(value, mulF(noiseLevel, loadF(out + i)));
+        storeF(out + i, value);
+    }
+    for (; i < count; i++) {
+        const float noise = noisy ? float(params.noiseLevel) * out[i] : 0.0f;
+        out[i] = float(params.dc) + float(params.amplitude) * m_shape[i] + noise;
+    }
+}
+
+void SignalGenerator::cyclesAt(int channel, double phase, double &whole, double &fraction) const
+{
+    // Cycles at position(), in parts: the whole count is exact, the fraction keeps
+    // its precision however long the generator has run
+    const ChannelOrigin &origin = m_channelOrigins[size_t(channel)];
+    const double frequency = m_params.channels[size_t(channel)].frequency;
+    const double elapsed = frequency / m_params.sampleRate * double(m_position - origin.position);
+    const double elapsedWhole = std::floor(elapsed);
+    fraction = origin.fraction + (elapsed - elapsedWhole) + (phase - std::floor(phase));
+    const double fractionWhole = std::floor(fraction);
+    whole = origin.whole + elapsedWhole + fractionWhole;
+    fraction -= fractionWhole;
+}
+
+bool SignalGenerator::sweepOf(const ChannelParams &params, Sweep &sweep)
+{
+    if (params.waveform != ChannelParams::Chirp && params.waveform != ChannelParams::Burst)
+        return false;
+    const bool chirp = params.waveform == ChannelParams::Chirp;
+    sweep.period = chirp ? params.sweepTime : params.burstPeriod;
+    sweep.onTime = chirp ? sweep.period : params.burstCycles / params.frequency;
+    sweep.rate = chirp ? (params.sweepFrequency - params.frequency) / sweep.period : 0.0;
+    return sweep.period > 0.0 && sweep.onTime > 0.0;
+}
+
+double SignalGenerator::periodStart(int channel, double period, double t) const
+{
+    const double anchor = m_channelOrigins[size_t(channel)].periodStart;
+    return anchor + std::floor((t - anchor) / period) * period;
+}
+
+double SignalGenerator::sweepCycles(int channel, const Sweep &sweep, uint64_t position, double start, double tau) const
+{
+    // Cycles since the period's start, without the phase: from the origin in the
+    // period that holds it, so a change of sweep keeps the phase continuous
+    const ChannelOrigin &origin = m_channelOrigins[size_t(channel)];
+    const double frequency = m_params.channels[size_t(channel)].frequency;
+    if (position >= origin.position && start == origin.periodStart)
+        return origin.fraction + frequency * (tau - origin.tau) + 0.5 * sweep.rate * (tau * tau - origin.tau * origin.tau);
+    return frequency * tau + 0.5 * sweep.rate * tau * tau;
+}
+
+void SignalGenerator::periodicOscillator(int channel, float *shape, size_t count)
+{
+    const ChannelParams &params = m_params.channels[size_t(channel)];
+    const double rate = m_params.sampleRate;
+    const double phase = params.phase / 360.0;
+
+    Sweep sweep;
+    if (!sweepOf(params, sweep)) {
+        double whole, fraction;
+        cyclesAt(channel, phase, whole, fraction);
+        oscillator(shape, count, fraction, params.frequency / rate, 0.0);
+        return;
+    }
+    const double period = sweep.period;
+    const double onTime = sweep.onTime;
+
+    // Every period restarts at phase, from its first sample on: sample k belongs to
+    // the period periodStart() puts it in, and the estimates below are trimmed to that rule
+    for (size_t i = 0; i < count;) {
+        const double t = timeAt(m_position + i);
+        const double start = periodStart(channel, period, t);
+        const double tau = t - start;
+        const double left = double(count - i);
+        size_t n = size_t(std::clamp(std::ceil((period - tau) * rate), 1.0, left));
+        while (n > 1 && periodStart(channel, period, timeAt(m_position + i + n - 1)) != start)
+            n--;
+        size_t on = size_t(std::clamp(std::ceil((onTime - tau) * rate), 0.0, double(n)));
+        while (on > 0 && timeAt(m_position + i + on - 1) - start >= onTime)
+            on--;
+
+        if (on > 0) {
+            const double frequency = params.frequency + sweep.rate * tau;
+            oscillator(shape + i, on, phase + sweepCycles(channel, sweep, m_position + i, start, tau),
+                       frequency / rate, 0.5 * sweep.rate / (rate * rate));
+        }
+        std::fill(shape + i + on, shape + i + n, 0.0f);
+        i += n;
+    }
+}
+
+void SignalGenerator::gaussian(float *out, size_t count)
+{
+    const ZigguratTables &z = ziggurat();
+    U32x4 s0 = loadU(m_state[0]);
+    U32x4 s1 = loadU(m_state[1]);
+    U32x4 s2 = loadU(m_state[2]);
+    U32x4 s3 = loadU(m_state[3]);
+    const U32x4 layerMask = setU(ZIGGURAT_LAYER_MASK);
+    alignas(16) uint32_t words[4];
+    alignas(16) uint32_t layers[4];
+
+    // Four candidates per step: x = word * w[layer], kept if |word| < k[layer]
+    auto next4 = [&](float *dst) {
+        const U32x4 word = nextWords(s0, s1, s2, s3);
+        const U32x4 layer = andU(word, layerMask);
+        storeU(layers, layer);
+        const U32x4 accepted = lessS(absS(word), gatherU(z.k, layers));
+        storeF(dst, mulF(toF(word), gatherF(z.w, layers)));
+
+        const int mask = laneMask(accepted);
+        if (mask != 0xf) {
+            storeU(words, word);
+            for (int lane = 0; lane < 4; lane++) {
+                if (!(mask & (1 << lane)))
+                    dst[lane] = gaussianSlow(int32_t(words[lane]), layers[lane]);
+            }
+        }
+    };
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        next4(out + i);
+    if (i < count) {
+        float rest[4];
+        next4(rest);
+        std::copy(rest, rest + (count - i), out + i);
+    }
+
+    storeU(m_state[0], s0);
+    storeU(m_state[1], s1);
+    storeU(m_state[2], s2);
+    storeU(m_state[3], s3);
+}
+
+float SignalGenerator::gaussianSlow(int32_t hz, uint32_t layer)
+{
+    const ZigguratTables &z = ziggurat();
+    for (;;) {
+        const float x = float(hz) * z.w[layer];
+        if (layer == 0) {
+            // Base layer: sample the tail beyond R
+            float tailX, tailY;
+            do {
+                tailX = -std::log(uniform()) / ZIGGURAT_R;
+                tailY = -std::log(uniform());
+            } while (tailY + tailY < tailX * tailX);
+            return hz > 0 ? ZIGGURAT_R + tailX : -ZIGGURAT_R - tailX;
+        }
+        // Wedge between the rectangle and the curve
+        if (z.f[layer] + uniform() * (z.f[layer - 1] - z.f[layer]) < std::exp(-0.5f * x * x))
+            return x;
+
+        // Rejected: a fresh candidate, same test as the vector path
+        hz = int32_t(nextScalar());
+        layer = uint32_t(hz) & ZIGGURAT_LAYER_MASK;
+        const uint32_t magnitude = hz < 0 ? 0u - uint32_t(hz) : uint32_t(hz);
+        if (magnitude < z.k[layer])
+            return float(hz) * z.w[layer];
+    }
+}
+
+uint32_t SignalGenerator::nextScalar()
+{
+    // xoshiro128++
+    uint32_t *s = m_scalarState;
+    const uint32_t result = rotl(s[0] + s[3], 7) + s[0];
+    const uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+float SignalGenerator::uniform()
+{
+    // Open interval (0, 1): the tail takes its log
+    return (float(nextScalar() >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
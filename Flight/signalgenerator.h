@@ -0,0 +1,175 @@
+#ifndef SIGNALGENERATOR_H
+#define SIGNALGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ChannelParams {
+    enum Waveform {
+        Sine,
+        Square,
+        Triangle,
+        Chirp,    // Linear sweep from frequency to sweepFrequency, restarting every sweepTime
+        Step,     // 0, then 1 from stepTime on
+        Impulse,  // 1 on the first sample of each cycle, else 0
+        Prbs,     // PRBS-15 of ±1, one chip per cycle
+        Burst     // burstCycles of sine every burstPeriod, silent in between
+    };
+
+    Waveform waveform = Sine;
+    double dc = 0.0;
+    double amplitude = 1.0;
+    double frequency = 1.0;  // Hz
+    double phase = 0.0;      // degrees
+    double noiseLevel = 0.01;
+
+    double duty = 0.5;             // Square: fraction of the cycle at +1
+    double sweepFrequency = 100.0; // Chirp: Hz at the end of a sweep
+    double sweepTime = 1.0;        // Chirp: seconds per sweep
+    double stepTime = 1.0;         // Step: seconds
+    double burstCycles = 5.0;      // Burst: cycles per burst
+    double burstPeriod = 1.0;      // Burst: seconds from one burst to the next
+};
+
+struct GeneratorParams {
+    static constexpr int DEFAULT_CHANNELS = 4;
+
+    double sampleRate = 1000.0;  // Hz
+    uint64_t seed = 0;           // Noise and PRBS streams; 0 for a different one every start
+    std::vector<ChannelParams> channels;
+
+    // Channel c at (c + 1) Hz, 35° behind the previous one
+    explicit GeneratorParams(int channelCount = DEFAULT_CHANNELS) : channels(size_t(channelCount))
+    {
+        for (int c = 0; c < channelCount; c++) {
+            channels[size_t(c)].frequency = c + 1.0;
+            channels[size_t(c)].phase = (35 * c) % 360;
+        }
+    }
+
+    int channelCount() const { return int(channels.size()); }
+};
+
+/**
+ * @brief Test signal kernel: dc + amplitude * waveform + noise per channel, four samples per step
+ *
+ * Any number of channels, each written to its own array: a channel costs the
+ * same however many others there are.
+ *
+ * Sine, chirp and burst run four phasors one sample apart and rotate them by
+ * four samples' worth of phase per step: a complex multiply instead of a sin()
+ * per sample (a chirp also rotates the step). The other waveforms are functions
+ * of the cycle fraction. Every BLOCK_SIZE samples the phase is recomputed
+ * exactly, in double from the sample index, so float rounding never accumulates
+ * and any waveform stays phase-continuous across batches, skips and rate changes.
+ *
+ * Noise is standard normal from a Ziggurat (Marsaglia and Tsang, 128 layers)
+ * fed by four interleaved xoshiro128++ streams: one vector of random words gives
+ * four candidates, of which about 99% are accepted by one table compare; the
+ * rest take the scalar wedge/tail path. Channels with no noise skip it.
+ *
+ * SSE2 or NEON when the target has them, plain C++ otherwise. Not thread-safe:
+ * one instance per producing thread.
+ */
+class SignalGenerator
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 512;  // Samples between oscillator resyncs
+
+    explicit SignalGenerator(uint64_t seed = 0x5eedf11e);
+
+    /**
+     * @brief Change the parameters from the next sample on
+     *
+     * A new sample rate or frequency applies from position() on: time and phase
+     * continue from where the old ones left them, so a stepped sweep has no
+     * phase jumps. A new phase is applied as such.
+     */
+    void setParams(const GeneratorParams &params);
+    const GeneratorParams &params() const { return m_params; }
+
+    /**
+     * @brief Index of the next sample
+     */
+    uint64_t position() const { return m_position; }
+
+    /**
+     * @brief Timestamp of the next sample in seconds
+     */
+    double time() const { return timeAt(m_position); }
+
+    /**
+     * @brief Restart at sample position, timestamp position / sampleRate
+     */
+    void seek(uint64_t position);
+
+    /**
+     * @brief Leave out the next count samples; time and phase move on as if they were generated
+     */
+    void skip(uint64_t count) { m_position += count; }
+
+    /**
+     * @brief Restart the noise streams and pick the PRBS offsets; the same seed gives the same signal again
+     */
+    void seed(uint64_t seed);
+
+    /**
+     * @brief Generate the next count samples
+     * @param t Timestamps in seconds, or nullptr
+     * @param y One output array per channel of params()
+     */
+    void generate(double *t, float *const *y, size_t count);
+
+    /**
+     * @brief Fill out with standard normal deviates
+     */
+    void gaussian(float *out, size_t count);
+
+private:
+    double timeAt(uint64_t position) const {
+        return m_originTime + double(position - m_originPosition) / m_params.sampleRate;
+    }
+    void generateChannel(int channel, float *out, size_t count);
+    void cyclesAt(int channel, double phase, double &whole, double &fraction) const;
+    void resetOrigins();
+
+    // Chirp and Burst: periods restart at the channel's phase, on a grid anchored
+    // at its origin's periodStart
+    struct Sweep {
+        double period;
+        double onTime;  // Sounding part of each period
+        double rate;    // Hz/s
+    };
+    static bool sweepOf(const ChannelParams &params, Sweep &sweep);
+    double periodStart(int channel, double period, double t) const;
+    double sweepCycles(int channel, const Sweep &sweep, uint64_t position, double start, double tau) const;
+    void periodicOscillator(int channel, float *shape, size_t count);
+    float gaussianSlow(int32_t hz, uint32_t layer);
+    uint32_t nextScalar();
+    float uniform();
+
+    GeneratorParams m_params;
+    uint64_t m_position;
+    uint64_t m_originPosition;  // Sample where the current sample rate took over
+    double m_originTime;        // and its timestamp
+
+    // Per channel: sample where its frequency (or the rate) last changed, and the
+    // cycles counted up to there, split so the fraction keeps its precision. For
+    // Chirp and Burst the cycles count from the start of the period holding that
+    // sample, which is also kept, with the sample's time into it.
+    struct ChannelOrigin {
+        uint64_t position;
+        double whole;
+        double fraction;
+        double periodStart;
+        double tau;
+    };
+    std::vector<ChannelOrigin> m_channelOrigins;
+    uint64_t m_seed;
+    alignas(16) uint32_t m_state[4][4];  // xoshiro128++ words, one lane per stream: m_state[word][lane]
+    uint32_t m_scalarState[4];           // Stream of the rejection path
+    alignas(16) float m_shape[BLOCK_SIZE + 4];  // Unit waveform of the current block
+};
+
+#endif // SIGNALGENERATOR_H
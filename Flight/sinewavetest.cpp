@@ -1,18 +1,45 @@
-#include "SineWaveTest.h"
+#include "sinewavetest.h"
 #include <QDebug>
 #include <QVariantList>
+#include <QtCharts/QXYSeries>
 #include <QtMath>
 #include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+// waveform<n> of a parameter map: one of these names, or its index
+const char* const WAVEFORM_NAMES[] = {"sine", "square", "triangle", "chirp", "step", "impulse", "prbs", "burst"};
+
+ChannelParams::Waveform waveformFromVariant(const QVariant& value, ChannelParams::Waveform fallback)
+{
+    const QString name = value.toString().toLower();
+    for (int i = ChannelParams::Sine; i <= ChannelParams::Burst; ++i) {
+        if (name == QLatin1String(WAVEFORM_NAMES[i]) || name == QString::number(i))
+            return static_cast<ChannelParams::Waveform>(i);
+    }
+    qWarning() << "SineWaveTest: Unknown waveform" << value;
+    return fallback;
+}
+}
 
 // SineWaveWorker Implementation
-SineWaveWorker::SineWaveWorker(RingBuffer<SampleData, 65536>* buffer, QObject* parent)
+SineWaveWorker::SineWaveWorker(SampleRingBuffer* buffer, QObject* parent)
     : QObject(parent)
     , m_buffer(buffer)
+    , m_sharedRing(nullptr)
     , m_timer(new QTimer(this))
+    , m_appliedVersion(0)
     , m_sampleCounter(0)
+    , m_skippedSamples(0)
     , m_running(false)
-    , m_rng(std::random_device{}())
-    , m_noiseDist(0.0, 1.0)
+    , m_rateBaseRate(0.0)
+    , m_rateBaseNs(0)
+    , m_rateBaseSamples(0)
+    , m_rateBaseSkipped(0)
+    , m_lastRateReportNs(0)
+    , m_generator((uint64_t(std::random_device{}()) << 32) | std::random_device{}())
+    , m_playbackOffset(0.0)
 {
     // High-precision timer for sample generation
     m_timer->setTimerType(Qt::PreciseTimer);
@@ -22,22 +49,40 @@ SineWaveWorker::SineWaveWorker(RingBuffer<SampleData, 65536>* buffer, QObject* p
     GeneratorParams defaultParams;
     setParams(defaultParams);
     
-    qDebug() << "SineWaveWorker: Initialized with" << SAMPLES_PER_BATCH << "samples/batch";
+    qDebug() << "SineWaveWorker: Initialized, deadline-driven from the elapsed timer";
 }
 
-void SineWaveWorker::setParams(const GeneratorParams& params)
+void SineWaveWorker::setParams(const GeneratorParams& params, uint64_t applyAt)
 {
     QMutexLocker locker(&m_paramsMutex);
+    // The generator divides by the rate: a bad one (e.g. from a playback file) keeps the last good one
+    const double previousRate = m_params.sampleRate;
     m_params = params;
+    if (!(params.sampleRate > 0.0) || !std::isfinite(params.sampleRate)) {
+        qWarning() << "SineWaveWorker: Sample rate" << params.sampleRate << "is not valid, keeping"
+                   << previousRate << "Hz";
+        m_params.sampleRate = previousRate;
+    }
+    const uint64_t version = m_paramsExchange.publish({m_params, applyAt});
     
-    // Update timer interval based on sample rate
-    // Generate SAMPLES_PER_BATCH samples per timer event
-    int intervalMs = static_cast<int>(1000.0 * SAMPLES_PER_BATCH / params.sampleRate);
-    intervalMs = std::max(1, intervalMs);  // Minimum 1ms
-    m_timer->setInterval(intervalMs);
+    qDebug() << "SineWaveWorker: Parameters" << version << "published - Sample rate:" << m_params.sampleRate
+             << "Hz, from sample" << applyAt;
+}
+
+void SineWaveWorker::setPlayback(std::unique_ptr<SampleFileReader> file, double speed)
+{
+    m_playback = std::move(file);
+    if (!m_playback)
+        return;
     
-    qDebug() << "SineWaveWorker: Parameters updated - Sample rate:" << params.sampleRate 
-             << "Hz, Timer interval:" << intervalMs << "ms";
+    if (!(speed > 0.0)) {
+        qWarning() << "SineWaveWorker: Playback speed" << speed << "is not positive, playing at 1x";
+        speed = 1.0;
+    }
+    GeneratorParams params = getParams();
+    params.sampleRate = m_playback->sampleRate() * speed;
+    setParams(params);
+    qDebug() << "SineWaveWorker: Playing back" << m_playback->sampleCount() << "samples at" << speed << "x";
 }
 
 GeneratorParams SineWaveWorker::getParams() const
@@ -50,7 +95,18 @@ void SineWaveWorker::start()
 {
     if (!m_running) {
         m_running = true;
+        m_paramsExchange.update();
+        const uint64_t seed = m_paramsExchange.front().params.seed;
         m_sampleCounter = 0;
+        m_skippedSamples = 0;
+        m_generator.seek(0);
+        m_generator.seed(seed ? seed : (uint64_t(std::random_device{}()) << 32) | std::random_device{}());
+        if (m_playback) {
+            m_playback->rewind();
+            m_playbackOffset = -m_playback->firstTimestamp();
+        }
+        m_rateBaseRate = 0.0;  // The latest parameters apply from sample 0, whatever their applyAt
+        applyParams(0);
         m_elapsedTimer.start();
         m_timer->start();
         
@@ -68,75 +124,187 @@ void SineWaveWorker::stop()
     }
 }
 
-void SineWaveWorker::reconfigure(const GeneratorParams& params)
-{
-    setParams(params);
-}
-
 void SineWaveWorker::generateSamples()
 {
-    if (!m_running || !m_buffer) return;
+    if (!m_running || (!m_buffer && !m_sharedRing)) return;
     
-    GeneratorParams params;
-    {
-        QMutexLocker locker(&m_paramsMutex);
-        params = m_params;
-    }
+    const qint64 nowNs = m_elapsedTimer.nsecsElapsed();
+    m_paramsExchange.update();  // One load while nothing was published
     
-    // Generate batch of samples
-    for (int i = 0; i < SAMPLES_PER_BATCH; ++i) {
-        // Deterministic timestamp: t = k/Fs
-        double t = static_cast<double>(m_sampleCounter) / params.sampleRate;
-        
-        SampleData sample;
-        sample.t = t;
-        
-        // Generate 4 channels: dc + amp*sin(2π f t + phase) + noise
-        for (int ch = 0; ch < 4; ++ch) {
-            double phaseRad = params.phase[ch] * M_PI / 180.0;  // Convert degrees to radians
-            double sineValue = params.amplitude[ch] * std::sin(2.0 * M_PI * params.frequency[ch] * t + phaseRad);
-            double noise = params.noiseLevel[ch] * m_noiseDist(m_rng);
-            
-            float channelValue = static_cast<float>(params.dc[ch] + sineValue + noise);
-            
-            switch (ch) {
-                case 0: sample.y0 = channelValue; break;
-                case 1: sample.y1 = channelValue; break;
-                case 2: sample.y2 = channelValue; break;
-                case 3: sample.y3 = channelValue; break;
-            }
+    for (;;) {
+        // Parameters waiting for their sample split the batch there
+        const bool pending = m_paramsExchange.frontVersion() != m_appliedVersion;
+        const uint64_t applyAt = m_paramsExchange.front().applyAt;
+        if (pending && applyAt <= m_sampleCounter) {
+            applyParams(nowNs);
+            continue;
         }
         
-        // Force push to ring buffer (never blocks producer)
-        m_buffer->force_push(sample);
-        m_sampleCounter++;
+        const uint64_t due = m_rateBaseSamples
+                             + static_cast<uint64_t>(static_cast<double>(nowNs - m_rateBaseNs) * 1e-9 * m_rateBaseRate);
+        if (due <= m_sampleCounter) break;
+        
+        const uint64_t count = (pending ? std::min(due, applyAt) : due) - m_sampleCounter;
+        const uint64_t before = m_sampleCounter;
+        if (m_sharedRing)
+            generateInto(*m_sharedRing, count);
+        else
+            generateInto(*m_buffer, count);
+        if (m_sampleCounter == before) break;
+    }
+    
+    if (nowNs - m_lastRateReportNs >= RATE_REPORT_INTERVAL_NS) {
+        m_lastRateReportNs = nowNs;
+        const uint64_t written = (m_sampleCounter - m_rateBaseSamples) - (m_skippedSamples - m_rateBaseSkipped);
+        emit achievedRateChanged(static_cast<double>(written) * 1e9 / static_cast<double>(nowNs - m_rateBaseNs));
     }
     
     // Debug output every 1000 batches (less frequent)
     static int batchCount = 0;
     if (++batchCount % 1000 == 0) {
-        double bufferUsage = m_buffer->usage() * 100.0;
-        qDebug() << "SineWaveWorker: Generated" << m_sampleCounter << "samples, buffer usage:" 
-                 << QString::number(bufferUsage, 'f', 1) << "%";
+        if (m_sharedRing) {
+            qDebug() << "SineWaveWorker: Generated" << m_sampleCounter << "samples into shared ring"
+                     << QString::fromStdString(m_sharedRing->name()) << "(" << m_skippedSamples << "skipped)";
+        } else {
+            double bufferUsage = m_buffer->usage() * 100.0;
+            qDebug() << "SineWaveWorker: Generated" << m_sampleCounter << "samples (" << m_skippedSamples
+                     << "skipped), buffer usage:" << QString::number(bufferUsage, 'f', 1) << "% behind the slowest reader";
+        }
+    }
+}
+
+void SineWaveWorker::applyParams(qint64 nowNs)
+{
+    // Copies only here, when something changed; one generator channel per ring column
+    GeneratorParams params = m_paramsExchange.front().params;
+    m_appliedVersion = m_paramsExchange.frontVersion();
+    params.channels.resize(static_cast<size_t>(m_sharedRing ? m_sharedRing->columns() : m_buffer->columns()));
+    m_generator.setParams(params);
+    
+    if (params.sampleRate != m_rateBaseRate) {
+        // The new rate counts from now; what was due at the old one stays due
+        m_rateBaseRate = params.sampleRate;
+        m_rateBaseNs = nowNs;
+        m_rateBaseSamples = m_sampleCounter;
+        m_rateBaseSkipped = m_skippedSamples;
+        m_lastRateReportNs = nowNs;
+        if (m_sharedRing)
+            m_sharedRing->setSampleRate(params.sampleRate);
+        
+        // The timer only sets how often we wake up: every wakeup writes whatever is
+        // due by then, so its rounding and jitter never show in the sample rate
+        const double intervalMs = std::clamp(1000.0 * SAMPLES_PER_BATCH / params.sampleRate,
+                                             1.0, double(MAX_WAKEUP_INTERVAL_MS));
+        m_timer->setInterval(static_cast<int>(intervalMs));
+    }
+    
+    qDebug() << "SineWaveWorker: Parameters" << m_appliedVersion << "applied at sample" << m_sampleCounter;
+}
+
+template<typename Ring>
+void SineWaveWorker::generateInto(Ring& ring, uint64_t count)
+{
+    // After a stall (suspend, debugger) anything beyond one ring's worth would be
+    // overwritten unseen: skip it, time and phase still advance
+    if (count > ring.capacity()) {
+        const uint64_t skipped = count - ring.capacity();
+        skip(skipped);
+        m_sampleCounter += skipped;
+        m_skippedSamples += skipped;
+        count = ring.capacity();
+    }
+    
+    // Write straight into the ring, timestamps into the slots and each channel
+    // into its column; a full ring overwrites its oldest samples
+    const typename Ring::WriteSpans spans = ring.reserve(static_cast<size_t>(count));
+    m_columns.resize(static_cast<size_t>(ring.columns()));
+    
+    for (int c = 0; c < ring.columns(); ++c)
+        m_columns[c] = ring.columnSpans(spans, c).first;
+    produce(spans.first, spans.first_size);
+    
+    for (int c = 0; c < ring.columns(); ++c)
+        m_columns[c] = ring.columnSpans(spans, c).second;
+    produce(spans.second, spans.second_size);
+    
+    ring.commit(spans.size());
+    m_sampleCounter += spans.size();
+}
+
+void SineWaveWorker::produce(double* t, size_t count)
+{
+    if (!m_playback) {
+        m_generator.generate(t, m_columns.data(), count);
+        return;
+    }
+    
+    // Columns the file does not have stay silent
+    const size_t channels = std::min(m_columns.size(), static_cast<size_t>(m_playback->channels()));
+    for (size_t c = channels; c < m_columns.size(); ++c)
+        std::fill(m_columns[c], m_columns[c] + count, 0.0f);
+    
+    for (size_t done = 0; done < count;) {
+        const size_t n = m_playback->read(t + done, m_columns.data(), static_cast<int>(channels), count - done);
+        for (size_t i = done; i < done + n; ++i)
+            t[i] += m_playbackOffset;
+        for (size_t c = 0; c < channels; ++c)
+            m_columns[c] += n;
+        done += n;
+        
+        if (m_playback->atEnd()) {
+            m_playback->rewind();
+            m_playbackOffset += m_playback->duration();
+        }
+    }
+}
+
+void SineWaveWorker::skip(uint64_t count)
+{
+    if (!m_playback) {
+        m_generator.skip(count);
+        return;
+    }
+    
+    while (count > 0) {
+        count -= m_playback->skip(static_cast<size_t>(std::min<uint64_t>(count, m_playback->sampleCount())));
+        if (m_playback->atEnd()) {
+            m_playback->rewind();
+            m_playbackOffset += m_playback->duration();
+        }
     }
 }
 
 // SineWaveTest Implementation
+QString SineWaveTest::s_defaultSharedSource;
+
+void SineWaveTest::setDefaultSharedSource(const QString& name)
+{
+    s_defaultSharedSource = name;
+}
+
 SineWaveTest::SineWaveTest(QObject* parent)
     : QObject(parent)
+    , m_uiReader(-1)
+    , m_requestedCapacity(DEFAULT_BUFFER_CAPACITY)
+    , m_requestedChannels(GeneratorParams::DEFAULT_CHANNELS)
+    , m_reportedDropped(0)
+    , m_achievedRate(0.0)
     , m_worker(nullptr)
     , m_workerThread(nullptr)
     , m_flushTimer(new QTimer(this))
+    , m_sharedSource(s_defaultSharedSource)
+    , m_sourceAlive(false)
     , m_running(false)
 {
     // Thread and worker will be created on demand in start()
+    allocateBuffer();
     
     // Setup UI flush timer (30 Hz)
     m_flushTimer->setTimerType(Qt::CoarseTimer);
     m_flushTimer->setInterval(static_cast<int>(1000.0 / UI_UPDATE_RATE));
     connect(m_flushTimer, &QTimer::timeout, this, &SineWaveTest::updateBufferUsage);
     
-    qDebug() << "SineWaveTest: Initialized with buffer capacity:" << m_buffer.capacity() 
+    qDebug() << "SineWaveTest: Initialized with buffer capacity:" << m_buffer->capacity() << "channels:" << channelCount()
              << "UI update rate:" << UI_UPDATE_RATE << "Hz";
 }
 
@@ -156,6 +324,9 @@ SineWaveTest::~SineWaveTest()
 
 double SineWaveTest::sampleRate() const
 {
+    if (m_sharedReader.isAttached()) {
+        return m_sharedReader.sampleRate();
+    }
     if (m_worker) {
         return m_worker->getParams().sampleRate;
     }
@@ -164,7 +335,100 @@ double SineWaveTest::sampleRate() const
 
 int SineWaveTest::bufferUsage() const
 {
-    return static_cast<int>(m_buffer.usage() * 100.0);
+    if (m_sharedReader.isAttached())
+        return static_cast<int>(m_sharedReader.usage() * 100.0);
+    return static_cast<int>(m_buffer->usage(m_uiReader) * 100.0);
+}
+
+qint64 SineWaveTest::droppedSamples() const
+{
+    if (m_sharedReader.isAttached())
+        return static_cast<qint64>(m_sharedReader.dropped());
+    return static_cast<qint64>(m_buffer->dropped(m_uiReader));
+}
+
+int SineWaveTest::maxBufferCapacity(int channels)
+{
+    const qint64 bytesPerSample = qint64(sizeof(double)) + qint64(sizeof(float)) * std::max(channels, 0);
+    int capacity = MIN_BUFFER_CAPACITY;
+    while (qint64(capacity) * 2 * bytesPerSample <= MAX_BUFFER_BYTES)
+        capacity *= 2;
+    return capacity;
+}
+
+int SineWaveTest::bufferCapacity() const
+{
+    return static_cast<int>(m_buffer->capacity());
+}
+
+int SineWaveTest::channelCount() const
+{
+    if (m_sharedReader.isAttached())
+        return m_sharedReader.columns();
+    return m_buffer->columns();
+}
+
+void SineWaveTest::setChannelCount(int channels)
+{
+    // Like the capacity: the ring is laid out for a channel count
+    QMutexLocker locker(&m_mutex);
+    m_requestedChannels = std::clamp(channels, 1, MAX_CHANNELS);
+    if (!m_running)
+        allocateBuffer();
+}
+
+void SineWaveTest::setBufferCapacity(int samples)
+{
+    // The worker holds the ring; swap it only while nothing writes to it
+    QMutexLocker locker(&m_mutex);
+    m_requestedCapacity = std::max(samples, MIN_BUFFER_CAPACITY);
+    if (!m_running)
+        allocateBuffer();
+}
+
+void SineWaveTest::setSharedSource(const QString& name)
+{
+    // Like the capacity, a new source is picked up by the next start()
+    QMutexLocker locker(&m_mutex);
+    if (name == m_sharedSource)
+        return;
+    m_sharedSource = name;
+    emit sharedSourceChanged(name);
+}
+
+void SineWaveTest::allocateBuffer()
+{
+    // The budget is in bytes: the more channels, the shorter the history
+    const int capacity = std::min(m_requestedCapacity, maxBufferCapacity(m_requestedChannels));
+    if (m_buffer && m_buffer->columns() == m_requestedChannels
+        && m_buffer->capacity() >= static_cast<size_t>(capacity)
+        && m_buffer->capacity() / 2 < static_cast<size_t>(capacity))
+        return;  // Already the power of 2 this request rounds up to
+
+    // The old history is kept until the new one is in hand, so a failed allocation loses nothing
+    std::unique_ptr<SampleRingBuffer> buffer(new SampleRingBuffer(static_cast<size_t>(capacity), SampleRingBuffer::Lossy,
+                                                                  m_requestedChannels));
+    if (buffer->isNull() && m_buffer) {
+        qWarning() << "SineWaveTest: Cannot allocate a ring buffer of" << capacity << "samples x" << m_requestedChannels
+                   << "channels, keeping" << m_buffer->capacity() << "x" << m_buffer->columns();
+        m_requestedCapacity = bufferCapacity();
+        m_requestedChannels = m_buffer->columns();
+        emit bufferCapacityChanged(bufferCapacity());
+        emit channelCountChanged(m_buffer->columns());
+        return;
+    }
+
+    const int oldChannels = m_buffer ? m_buffer->columns() : 0;
+    m_buffer = std::move(buffer);
+    m_uiReader = m_buffer->addReader();
+
+    const size_t bytesPerSample = sizeof(double) + sizeof(float) * static_cast<size_t>(m_requestedChannels);
+    qDebug() << "SineWaveTest: Ring buffer of" << m_buffer->capacity() << "samples x" << m_buffer->columns()
+             << "channels (" << (m_buffer->capacity() * bytesPerSample) / 1024 << "KiB) backed by"
+             << m_buffer->backingName();
+    emit bufferCapacityChanged(bufferCapacity());
+    if (m_buffer->columns() != oldChannels)
+        emit channelCountChanged(m_buffer->columns());
 }
 
 void SineWaveTest::start()
@@ -189,25 +453,67 @@ void SineWaveTest::start(const QVariantMap& params)
             m_worker = nullptr; // Worker will be deleted by thread cleanup
         }
         
+        if (params.contains("sharedSource") && params["sharedSource"].toString() != m_sharedSource) {
+            m_sharedSource = params["sharedSource"].toString();
+            emit sharedSourceChanged(m_sharedSource);
+        }
+        
+        if (!m_sharedSource.isEmpty()) {
+            // Samples come from another process: no worker, just follow its ring
+            m_running = true;
+            pollSharedSource();
+            m_flushTimer->start();
+            
+            emit runningChanged(true);
+            
+            qDebug() << "SineWaveTest: Started on shared source" << m_sharedSource
+                     << (m_sharedReader.isAttached() ? "" : "(waiting for the writer)");
+            return;
+        }
+        
+        // A recording brings its own channel count
+        std::unique_ptr<SampleFileReader> playback;
+        if (!params.value("playbackFile").toString().isEmpty()) {
+            playback.reset(new SampleFileReader);
+            if (!playback->open(params["playbackFile"].toString()))
+                playback.reset();
+        }
+        
+        // The worker captures the ring, so any new capacity is applied first
+        if (params.contains("bufferCapacity"))
+            m_requestedCapacity = std::max(params["bufferCapacity"].toInt(), MIN_BUFFER_CAPACITY);
+        if (params.contains("channels"))
+            m_requestedChannels = std::clamp(params["channels"].toInt(), 1, MAX_CHANNELS);
+        if (playback)
+            m_requestedChannels = std::min(playback->channels(), MAX_CHANNELS);
+        allocateBuffer();
+        
         // Create new thread and worker for restart
         m_workerThread = new QThread(this);
-        m_worker = new SineWaveWorker(&m_buffer);
+        m_worker = new SineWaveWorker(m_buffer.get());
         m_worker->moveToThread(m_workerThread);
         
         // Reconnect thread lifecycle signals
         connect(m_workerThread, &QThread::started, m_worker, &SineWaveWorker::start);
         connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+        connect(m_worker, &SineWaveWorker::achievedRateChanged, this, [this](double rate) {
+            m_achievedRate = rate;
+            emit achievedRateChanged(rate);
+        });
         
         // Configure parameters if provided
         if (!params.isEmpty()) {
-            GeneratorParams genParams = variantMapToParams(params);
+            GeneratorParams genParams = variantMapToParams(params, GeneratorParams(m_buffer->columns()));
             m_worker->setParams(genParams);
         }
+        if (playback)
+            m_worker->setPlayback(std::move(playback), params.value("playbackSpeed", 1.0).toDouble());
         
         m_running = true;
         
-        // Clear buffer before starting
-        m_buffer.clear();
+        // Clear buffer and its drop count before starting
+        m_buffer->clear(m_uiReader);
+        m_decimator.reset(0, 1);
         
         m_workerThread->start();
         m_flushTimer->start();
@@ -234,6 +540,12 @@ void SineWaveTest::stop()
             QMetaObject::invokeMethod(m_worker, "stop", Qt::BlockingQueuedConnection);
         }
         
+        if (m_sharedReader.isAttached()) {
+            m_sharedReader.detach();
+            m_sourceAlive = false;
+            emit sourceAliveChanged(false);
+        }
+        
         // Then stop the thread gracefully
         if (m_workerThread && m_workerThread->isRunning()) {
             m_workerThread->quit();
@@ -255,9 +567,9 @@ void SineWaveTest::stop()
 void SineWaveTest::reconfigure(const QVariantMap& params)
 {
     if (m_worker && !params.isEmpty()) {
-        GeneratorParams genParams = variantMapToParams(params);
-        QMetaObject::invokeMethod(m_worker, "reconfigure", Qt::QueuedConnection, 
-                                Q_ARG(GeneratorParams, genParams));
+        // Only the keys given change; "applyAt" is the sample the change starts at
+        const GeneratorParams genParams = variantMapToParams(params, m_worker->getParams());
+        m_worker->setParams(genParams, params.value("applyAt").toULongLong());
         
         emit sampleRateChanged(sampleRate());
         
@@ -274,73 +586,131 @@ void SineWaveTest::setSampleRate(double rate)
     }
 }
 
-void SineWaveTest::flushToQml(QObject* qmlOscilloscope)
+double SineWaveTest::flushToQml(const QVariantList& series, double valueScale)
 {
-    if (!qmlOscilloscope) return;
+    // Read everything since the last flush in place, so that the display keeps up
+    // at any sample rate the decimation does
+    const bool shared = m_sharedReader.isAttached();
+    const SampleRingBuffer::ReadSpans samples = shared ? m_sharedReader.peek()
+                                                       : m_buffer->peek(m_uiReader);
+    const size_t sampleCount = samples.size();
     
-    // Pop up to MAX_BATCH_SIZE samples from ring buffer
-    SampleData samples[MAX_BATCH_SIZE];
-    size_t sampleCount = m_buffer.pop_batch(samples, MAX_BATCH_SIZE);
+    if (sampleCount == 0) return qQNaN();
     
-    if (sampleCount == 0) return;
+    // One bucket per ~150 points/sec/channel display rate, each drawn as its
+    // minimum and maximum so that spikes between the points still show
+    const size_t bucket = static_cast<size_t>(std::max(1.0, std::ceil(sampleRate() / DEFAULT_DISPLAY_RATE)));
+    const int channels = std::min(channelCount(), static_cast<int>(series.size()));
+    if (m_decimator.bucketSize() != bucket || m_decimator.channels() != channels)
+        m_decimator.reset(channels, bucket);
     
-    // Calculate decimation stride for ~150 points/sec/channel display rate
-    double currentSampleRate = sampleRate();
-    int stride = static_cast<int>(std::ceil(currentSampleRate / DEFAULT_DISPLAY_RATE));
-    stride = std::max(1, stride);
+    // Hidden channels are not decimated at all
+    std::vector<QXYSeries*> targets(static_cast<size_t>(channels), nullptr);
+    std::vector<const float*> first(static_cast<size_t>(channels), nullptr);
+    std::vector<const float*> second(static_cast<size_t>(channels), nullptr);
+    for (int c = 0; c < channels; ++c) {
+        QXYSeries* xySeries = qobject_cast<QXYSeries*>(series[c].value<QObject*>());
+        if (!xySeries || !xySeries->isVisible()) continue;
+        targets[c] = xySeries;
+        
+        const RingSpans<const float> column = shared ? m_sharedReader.columnSpans(samples, c)
+                                                     : m_buffer->columnSpans(samples, c);
+        first[c] = column.first;
+        second[c] = column.second;
+    }
+    m_decimator.add(samples.first, first.data(), samples.first_size);
+    m_decimator.add(samples.second, second.data(), samples.second_size);
     
-    // Prepare decimated data for QML
-    QVariantList timestamps, ch0, ch1, ch2, ch3;
+    // The generator may have lapped the front of the range while it was read:
+    // only the buckets it touched are dropped, the display skips over them
+    const size_t torn = shared ? m_sharedReader.consume(sampleCount) : m_buffer->consume(m_uiReader, sampleCount);
+    m_decimator.discardFront(torn);
+    
+    const size_t pointCount = m_decimator.pointCount();
+    if (pointCount == 0) {
+        m_decimator.clearPoints();
+        return qQNaN();
+    }
     
-    for (size_t i = 0; i < sampleCount; i += stride) {
-        const SampleData& sample = samples[i];
+    // Each visible channel keeps its last MAX_SERIES_POINTS points in one contiguous
+    // QList<QPointF>: nothing is boxed, and the series takes the whole list in a
+    // single replace(), one change notification per flush instead of one per point
+    m_seriesPoints.resize(static_cast<size_t>(channels));
+    const double* times = m_decimator.times();
+    for (int c = 0; c < channels; ++c) {
+        QXYSeries* xySeries = targets[c];
+        if (!xySeries) continue;
         
-        timestamps.append(sample.t);
-        ch0.append(sample.y0);
-        ch1.append(sample.y1);
-        ch2.append(sample.y2);
-        ch3.append(sample.y3);
-    }
-    
-    if (!timestamps.isEmpty()) {
-        // Call QML method to add samples
-        QMetaObject::invokeMethod(qmlOscilloscope, "addSamples",
-                                Q_ARG(QVariant, QVariant::fromValue(timestamps)),
-                                Q_ARG(QVariant, QVariant::fromValue(ch0)),
-                                Q_ARG(QVariant, QVariant::fromValue(ch1)),
-                                Q_ARG(QVariant, QVariant::fromValue(ch2)),
-                                Q_ARG(QVariant, QVariant::fromValue(ch3)));
+        // A series cleared or refilled elsewhere (the Clear button) starts over
+        QList<QPointF>& history = m_seriesPoints[c];
+        if (history.size() != xySeries->count())
+            history.clear();
         
-        // Debug output (less frequent)
-        static int flushCount = 0;
-        if (++flushCount % 30 == 0) {  // Every second at 30 Hz
-            qDebug() << "SineWaveTest: Flushed" << timestamps.size() << "points to QML"
-                     << "(stride=" << stride << ", buffer usage=" << bufferUsage() << "%)";
-        }
+        const float* values = m_decimator.values(c);
+        const size_t kept = std::min(pointCount, static_cast<size_t>(MAX_SERIES_POINTS));
+        for (size_t i = pointCount - kept; i < pointCount; ++i)
+            history.append(QPointF(times[i], values[i] * valueScale));
+        if (history.size() > MAX_SERIES_POINTS)
+            history.remove(0, history.size() - MAX_SERIES_POINTS);
+        xySeries->replace(history);
+    }
+    const double lastTime = times[pointCount - 1];
+    m_decimator.clearPoints();
+    
+    // Debug output (less frequent)
+    static int flushCount = 0;
+    if (++flushCount % 30 == 0) {  // Every second at 30 Hz
+        qDebug() << "SineWaveTest: Flushed" << pointCount << "points per channel"
+                 << "(min/max of" << bucket << "samples, buffer usage=" << bufferUsage() << "%, dropped="
+                 << droppedSamples() << ")";
     }
+    
+    return lastTime;
 }
 
-GeneratorParams SineWaveTest::variantMapToParams(const QVariantMap& map) const
+GeneratorParams SineWaveTest::variantMapToParams(const QVariantMap& map, GeneratorParams params) const
 {
-    GeneratorParams params;
-    
-    if (map.contains("sampleRate"))
-        params.sampleRate = map["sampleRate"].toDouble();
+    if (map.contains("sampleRate")) {
+        bool ok = false;
+        const double rate = map["sampleRate"].toDouble(&ok);
+        if (ok && rate > 0.0 && std::isfinite(rate))
+            params.sampleRate = rate;
+        else
+            qWarning() << "SineWaveTest: Ignoring sample rate" << map["sampleRate"] << "- keeping" << params.sampleRate << "Hz";
+    }
+    if (map.contains("seed"))
+        params.seed = map["seed"].toULongLong();
     
-    // Channel arrays
-    for (int ch = 0; ch < 4; ++ch) {
+    // Per-channel keys: waveform0, dc0, amplitude0, ... for channel 0
+    for (int ch = 0; ch < params.channelCount(); ++ch) {
         QString chStr = QString::number(ch);
+        ChannelParams& channel = params.channels[ch];
         
         if (map.contains("dc" + chStr))
-            params.dc[ch] = map["dc" + chStr].toDouble();
+            channel.dc = map["dc" + chStr].toDouble();
         if (map.contains("amplitude" + chStr))
-            params.amplitude[ch] = map["amplitude" + chStr].toDouble();
+            channel.amplitude = map["amplitude" + chStr].toDouble();
         if (map.contains("frequency" + chStr))
-            params.frequency[ch] = map["frequency" + chStr].toDouble();
+            channel.frequency = map["frequency" + chStr].toDouble();
         if (map.contains("phase" + chStr))
-            params.phase[ch] = map["phase" + chStr].toDouble();
+            channel.phase = map["phase" + chStr].toDouble();
         if (map.contains("noise" + chStr))
-            params.noiseLevel[ch] = map["noise" + chStr].toDouble();
+            channel.noiseLevel = map["noise" + chStr].toDouble();
+        
+        if (map.contains("waveform" + chStr))
+            channel.waveform = waveformFromVariant(map["waveform" + chStr], channel.waveform);
+        if (map.contains("duty" + chStr))
+            channel.duty = map["duty" + chStr].toDouble();
+        if (map.contains("sweepFrequency" + chStr))
+            channel.sweepFrequency = map["sweepFrequency" + chStr].toDouble();
+        if (map.contains("sweepTime" + chStr))
+            channel.sweepTime = map["sweepTime" + chStr].toDouble();
+        if (map.contains("stepTime" + chStr))
+            channel.stepTime = map["stepTime" + chStr].toDouble();
+        if (map.contains("burstCycles" + chStr))
+            channel.burstCycles = map["burstCycles" + chStr].toDouble();
+        if (map.contains("burstPeriod" + chStr))
+            channel.burstPeriod = map["burstPeriod" + chStr].toDouble();
     }
     
     return params;
@@ -348,7 +718,49 @@ GeneratorParams SineWaveTest::variantMapToParams(const QVariantMap& map) const
 
 void SineWaveTest::updateBufferUsage()
 {
+    if (!m_sharedSource.isEmpty())
+        pollSharedSource();
+    
     emit bufferUsageChanged(bufferUsage());
+
+    const qint64 dropped = droppedSamples();
+    if (dropped != m_reportedDropped) {
+        m_reportedDropped = dropped;
+        emit droppedSamplesChanged(dropped);
+    }
 }
 
-#include "SineWaveTest.moc"
+
+void SineWaveTest::pollSharedSource()
+{
+    // A writer that exits leaves its segment behind, a restarted one replaces it
+    if (m_sharedReader.isAttached()) {
+        const SharedSampleReader::WriterState state = m_sharedReader.writerState(SOURCE_STALE_NS);
+        if (state == SharedSampleReader::Closed || state == SharedSampleReader::Dead) {
+            qWarning() << "SineWaveTest: Shared source" << m_sharedSource
+                       << (state == SharedSampleReader::Closed ? "closed" : "died") << ", waiting for a new writer";
+            m_sharedReader.detach();
+            emit channelCountChanged(channelCount());
+        }
+    }
+    
+    if (!m_sharedReader.isAttached() && m_sharedReader.attach(m_sharedSource.toStdString())) {
+        const SharedSampleReader::WriterState state = m_sharedReader.writerState(SOURCE_STALE_NS);
+        if (state == SharedSampleReader::Closed || state == SharedSampleReader::Dead) {
+            m_sharedReader.detach();  // The old segment, not replaced yet
+        } else {
+            qDebug() << "SineWaveTest: Attached to shared source" << m_sharedSource << "with"
+                     << m_sharedReader.capacity() << "samples x" << m_sharedReader.columns() << "channels at"
+                     << m_sharedReader.sampleRate() << "Hz";
+            emit sampleRateChanged(sampleRate());
+            emit channelCountChanged(channelCount());
+        }
+    }
+    
+    const bool alive = m_sharedReader.isAttached()
+                       && m_sharedReader.writerState(SOURCE_STALE_NS) == SharedSampleReader::Alive;
+    if (alive != m_sourceAlive) {
+        m_sourceAlive = alive;
+        emit sourceAliveChanged(alive);
+    }
+}
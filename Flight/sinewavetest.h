@@ -2,6 +2,7 @@
 #define SINEWAVETEST_H
 
 #include <QObject>
+#include <QString>
 #include <QThread>
 #include <QTimer>
 #include <QElapsedTimer>
@@ -10,58 +11,102 @@
 #include <QVariant>
 #include <QVariantMap>
 #include <QVariantList>
+#include <QList>
+#include <QPointF>
 #include <QtQml/qqmlregistration.h>
-#include "RingBuffer.h"
+#include "BroadcastRingBuffer.h"
+#include "SharedRingBuffer.h"
+#include "TripleBuffer.h"
+#include "minmaxdecimator.h"
+#include "samplefile.h"
+#include "signalgenerator.h"
 #include <cmath>
-#include <random>
+#include <memory>
+#include <vector>
 
-struct SampleData {
-    double t;     // Timestamp in seconds
-    float y0, y1, y2, y3;  // Channel values
-};
+// One stream, many readers (UI, recorders, analytics); the generator never waits
+// on any of them: a reader that falls behind loses its oldest samples.
+// Columnar: a slot holds the timestamp in seconds, column c channel c's value
+typedef BroadcastRingBuffer<double, float> SampleRingBuffer;
 
-struct GeneratorParams {
-    double sampleRate = 1000.0;  // Hz
-    double dc[4] = {0.0, 0.0, 0.0, 0.0};
-    double amplitude[4] = {1.0, 1.0, 1.0, 1.0};
-    double frequency[4] = {1.0, 2.0, 3.0, 4.0};  // Hz
-    double phase[4] = {0.0, 35.0, 70.0, 105.0};  // degrees
-    double noiseLevel[4] = {0.01, 0.01, 0.01, 0.01};
-};
+// The same stream published by a separate acquisition process (--acquire)
+typedef SharedRingWriter<double, float> SharedSampleWriter;
+typedef SharedRingReader<double, float> SharedSampleReader;
 
 class SineWaveWorker : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit SineWaveWorker(RingBuffer<SampleData, 65536>* buffer, QObject* parent = nullptr);
+    explicit SineWaveWorker(SampleRingBuffer* buffer, QObject* parent = nullptr);
+    
+    // Any thread. Takes effect at sample applyAt (counted from start()), or with
+    // the next sample once that has passed; a later call replaces one not yet applied.
+    void setParams(const GeneratorParams& params, uint64_t applyAt = 0);
+    GeneratorParams getParams() const;  // As last set
+    
+    // Publish to a shared-memory ring instead of the in-process one (set before start())
+    void setSharedRing(SharedSampleWriter* ring) { m_sharedRing = ring; }
     
-    void setParams(const GeneratorParams& params);
-    GeneratorParams getParams() const;
+    // Play a sample file, looped, instead of generating (set before start()). The
+    // sample rate becomes the file's times speed; a later one changes the speed.
+    void setPlayback(std::unique_ptr<SampleFileReader> file, double speed);
 
 public slots:
     void start();
     void stop();
-    void reconfigure(const GeneratorParams& params);
+
+signals:
+    // Samples per second actually written since the rate was last set, about once a second
+    void achievedRateChanged(double rate);
 
 private slots:
     void generateSamples();
 
 private:
-    RingBuffer<SampleData, 65536>* m_buffer;
+    struct ScheduledParams {
+        GeneratorParams params;
+        uint64_t applyAt = 0;
+    };
+    
+    void applyParams(qint64 nowNs);
+    template<typename Ring>
+    void generateInto(Ring& ring, uint64_t count);
+    void produce(double* t, size_t count);
+    void skip(uint64_t count);
+    
+    SampleRingBuffer* m_buffer;
+    SharedSampleWriter* m_sharedRing;
     QTimer* m_timer;
     QElapsedTimer m_elapsedTimer;
-    GeneratorParams m_params;
-    mutable QMutex m_paramsMutex;
     
-    uint64_t m_sampleCounter;
+    // setParams() publishes, the generator polls one flag per wakeup and never locks
+    TripleBuffer<ScheduledParams> m_paramsExchange;
+    uint64_t m_appliedVersion;
+    GeneratorParams m_params;       // As last set
+    mutable QMutex m_paramsMutex;   // Serialises setParams() callers
+    
+    uint64_t m_sampleCounter;   // Samples due so far, written or skipped
+    uint64_t m_skippedSamples;  // Owed while stalled for longer than the ring holds
     bool m_running;
     
-    // Random number generation
-    std::mt19937 m_rng;
-    std::normal_distribution<double> m_noiseDist;
+    // Deadline: at m_elapsedTimer time t, rateBaseSamples + (t - rateBaseNs) * rate samples are due
+    double m_rateBaseRate;
+    qint64 m_rateBaseNs;
+    uint64_t m_rateBaseSamples;
+    uint64_t m_rateBaseSkipped;
+    qint64 m_lastRateReportNs;
+    
+    // Writes each channel straight into its ring column
+    SignalGenerator m_generator;
+    std::vector<float*> m_columns;
     
-    static constexpr int SAMPLES_PER_BATCH = 100;  // Generate samples in batches
+    std::unique_ptr<SampleFileReader> m_playback;
+    double m_playbackOffset;  // Added to the file's timestamps: each pass continues the last
+    
+    static constexpr int SAMPLES_PER_BATCH = 100;      // Wakeup interval target at low rates
+    static constexpr int MAX_WAKEUP_INTERVAL_MS = 10;  // Latency bound at low rates
+    static constexpr qint64 RATE_REPORT_INTERVAL_NS = 1000000000;
 };
 
 class SineWaveTest : public QObject
@@ -71,50 +116,103 @@ class SineWaveTest : public QObject
     
     Q_PROPERTY(bool running READ running NOTIFY runningChanged)
     Q_PROPERTY(double sampleRate READ sampleRate WRITE setSampleRate NOTIFY sampleRateChanged)
+    Q_PROPERTY(double achievedRate READ achievedRate NOTIFY achievedRateChanged)
     Q_PROPERTY(int bufferUsage READ bufferUsage NOTIFY bufferUsageChanged)
+    Q_PROPERTY(qint64 droppedSamples READ droppedSamples NOTIFY droppedSamplesChanged)
+    Q_PROPERTY(int bufferCapacity READ bufferCapacity WRITE setBufferCapacity NOTIFY bufferCapacityChanged)
+    Q_PROPERTY(int channelCount READ channelCount WRITE setChannelCount NOTIFY channelCountChanged)
+    Q_PROPERTY(QString sharedSource READ sharedSource WRITE setSharedSource NOTIFY sharedSourceChanged)
+    Q_PROPERTY(bool sourceAlive READ sourceAlive NOTIFY sourceAliveChanged)
 
 public:
+    static constexpr int MAX_CHANNELS = 64;
+    static constexpr int MIN_BUFFER_CAPACITY = 4096;             // samples
+    static constexpr qint64 MAX_BUFFER_BYTES = qint64(1) << 30;  // Timestamps and channels together
+
+    // Largest ring capacity (a power of 2, as rings round up) whose samples of
+    // channels fit in MAX_BUFFER_BYTES
+    static int maxBufferCapacity(int channels);
+
     explicit SineWaveTest(QObject* parent = nullptr);
     ~SineWaveTest();
     
     bool running() const { return m_running; }
     double sampleRate() const;
+    double achievedRate() const { return m_achievedRate; }
     int bufferUsage() const;
+    qint64 droppedSamples() const;
+    int bufferCapacity() const;
+    int channelCount() const;
+    QString sharedSource() const { return m_sharedSource; }
+    bool sourceAlive() const { return m_sourceAlive; }
+    
+    // Initial sharedSource of every new instance (--attach)
+    static void setDefaultSharedSource(const QString& name);
     
     Q_INVOKABLE void start();
     Q_INVOKABLE void start(const QVariantMap& params);
     Q_INVOKABLE void stop();
     Q_INVOKABLE void reconfigure(const QVariantMap& params);
     
-    // Called from UI thread at 30 Hz to flush data to QML
-    Q_INVOKABLE void flushToQml(QObject* qmlOscilloscope);
+    // Called from UI thread at 30 Hz: appends the new decimated points, times
+    // valueScale, to series (one XY series per channel, hidden ones skipped) and
+    // returns the last timestamp, or NaN when there was nothing new
+    Q_INVOKABLE double flushToQml(const QVariantList& series, double valueScale);
+    
+    // Shared sample stream for further readers (addReader()); replaced, with all
+    // registrations, when the capacity or channel count changes (bufferCapacityChanged)
+    SampleRingBuffer* sampleStream() const { return m_buffer.get(); }
 
 public slots:
     void setSampleRate(double rate);
+    void setBufferCapacity(int samples);
+    void setChannelCount(int channels);
+    void setSharedSource(const QString& name);
 
 signals:
     void runningChanged(bool running);
     void sampleRateChanged(double rate);
+    void achievedRateChanged(double rate);
     void bufferUsageChanged(int usage);
-    void samplesReady(const QVariantList& timestamps, const QVariantList& channel0,
-                     const QVariantList& channel1, const QVariantList& channel2, 
-                     const QVariantList& channel3);
+    void droppedSamplesChanged(qint64 dropped);
+    void bufferCapacityChanged(int samples);
+    void channelCountChanged(int channels);
+    void sharedSourceChanged(const QString& name);
+    void sourceAliveChanged(bool alive);
+    void samplesReady(const QVariantList& timestamps, const QVariantList& channels);
 
 private:
-    GeneratorParams variantMapToParams(const QVariantMap& map) const;
+    GeneratorParams variantMapToParams(const QVariantMap& map, GeneratorParams params) const;
     void updateBufferUsage();
+    void allocateBuffer();
+    void pollSharedSource();
     
-    RingBuffer<SampleData, 65536> m_buffer;
+    std::unique_ptr<SampleRingBuffer> m_buffer;
+    int m_uiReader;           // flushToQml()'s cursor on m_buffer
+    MinMaxDecimator m_decimator;                 // flushToQml()'s, carries a bucket across flushes
+    std::vector<QList<QPointF>> m_seriesPoints;  // flushToQml()'s per-channel history, as in the series
+    int m_requestedCapacity;  // Applied while stopped, or on the next start()
+    int m_requestedChannels;  // Likewise
+    qint64 m_reportedDropped;
+    double m_achievedRate;    // Last report of m_worker
     SineWaveWorker* m_worker;
     QThread* m_workerThread;
     QTimer* m_flushTimer;
     
+    // Set when the samples come from another process instead of m_worker
+    QString m_sharedSource;
+    SharedSampleReader m_sharedReader;
+    bool m_sourceAlive;
+    static QString s_defaultSharedSource;
+    
     bool m_running;
     mutable QMutex m_mutex;
     
-    static constexpr int MAX_BATCH_SIZE = 5000;
+    static constexpr int DEFAULT_BUFFER_CAPACITY = 65536;  // samples
     static constexpr double UI_UPDATE_RATE = 30.0;  // Hz
     static constexpr int DEFAULT_DISPLAY_RATE = 150;  // points/sec/channel
+    static constexpr int MAX_SERIES_POINTS = 1000;    // History kept per series, two per bucket
+    static constexpr qint64 SOURCE_STALE_NS = 1000000000;  // No commit for 1 s: source is not alive
 };
 
 #endif // SINEWAVETEST_H
\ No newline at end of file
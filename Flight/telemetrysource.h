@@ -0,0 +1,71 @@
+#ifndef TELEMETRYSOURCE_H
+#define TELEMETRYSOURCE_H
+
+#include <QtGlobal>
+#include <chrono>
+
+/**
+ * @brief One decoded telemetry value on the host timeline
+ *
+ * timestampNs is always host CLOCK_MONOTONIC (steady_clock) nanoseconds so that
+ * samples coming from different links can be compared directly.
+ */
+struct TelemetrySample {
+    qint64 timestampNs;
+    quint16 channel;   // Frame command that carried the value, or the source's channel index
+    quint8 link;       // Link of the vehicle the sample arrived on
+    float value;
+};
+
+/**
+ * @brief Receiver side of a TelemetrySource
+ *
+ * Byte oriented sources (serial, UDP, replay) hand over raw chunks exactly as they
+ * were received; sample oriented sources (IIO, generators) hand over samples.
+ */
+class SourceSink
+{
+public:
+    virtual ~SourceSink() = default;
+
+    virtual void chunkReceived(const quint8 *data, qint64 length, qint64 timestampNs) = 0;
+    virtual void samplesReceived(const TelemetrySample *samples, int count)
+    {
+        Q_UNUSED(samples);
+        Q_UNUSED(count);
+    }
+};
+
+/**
+ * @brief Abstract acquisition source driven by a worker thread
+ *
+ * poll() blocks for at most timeoutMs, delivers everything that is available to
+ * the sink and returns the number of bytes (or samples) delivered, 0 on timeout
+ * and -1 on error.
+ */
+class TelemetrySource
+{
+public:
+    virtual ~TelemetrySource() = default;
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual qint64 poll(SourceSink &sink, int timeoutMs) = 0;
+
+    // Pollable file descriptor, or -1 when the source has none
+    virtual int handle() const { return -1; }
+};
+
+namespace HostClock {
+
+// Host monotonic time in nanoseconds, the common timeline of all sources
+inline qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+#endif // TELEMETRYSOURCE_H
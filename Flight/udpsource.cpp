@@ -0,0 +1,194 @@
+#include "udpsource.h"
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+struct UdpSource::Batch {
+    quint8 buffers[BATCH_SIZE][MAX_DATAGRAM_SIZE];
+    struct iovec iov[BATCH_SIZE];
+    struct mmsghdr msgs[BATCH_SIZE];
+    char control[BATCH_SIZE][CMSG_SPACE(sizeof(struct timespec))];
+};
+
+static qint64 timespecToNs(const struct timespec &ts)
+{
+    return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+#else
+struct UdpSource::Batch {};
+#endif
+
+UdpSource::UdpSource(quint16 port, const QString &bindAddress) :
+    m_port(port),
+    m_bindAddress(bindAddress),
+    m_fd(-1),
+    m_batch(nullptr),
+    m_datagramsReceived(0),
+    m_truncatedDatagrams(0)
+{
+}
+
+UdpSource::~UdpSource()
+{
+    close();
+}
+
+bool UdpSource::open()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0)
+        return true;
+
+    m_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        qWarning() << "UdpSource: socket() failed:" << strerror(errno);
+        return false;
+    }
+
+    int one = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) < 0)
+        qWarning() << "UdpSource: SO_TIMESTAMPNS unavailable, using receive time";
+
+    // Absorb scheduling hiccups at 100k+ datagrams/s
+    int rcvBuf = 8 * 1024 * 1024;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (!m_bindAddress.isEmpty()
+        && ::inet_pton(AF_INET, m_bindAddress.toLatin1().constData(), &addr.sin_addr) != 1) {
+        qWarning() << "UdpSource: invalid bind address" << m_bindAddress;
+        close();
+        return false;
+    }
+
+    if (::bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        qWarning() << "UdpSource: bind() to port" << m_port << "failed:" << strerror(errno);
+        close();
+        return false;
+    }
+
+    // All receive buffers are allocated here once; poll() never allocates
+    m_batch = new Batch;
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        m_batch->iov[i].iov_base = m_batch->buffers[i];
+        m_batch->iov[i].iov_len = MAX_DATAGRAM_SIZE;
+    }
+
+    qDebug() << "UdpSource: Listening on port" << m_port;
+    return true;
+#else
+    qWarning() << "UdpSource: recvmmsg() ingestion is only available on Linux";
+    return false;
+#endif
+}
+
+void UdpSource::close()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    delete m_batch;
+    m_batch = nullptr;
+}
+
+qint64 UdpSource::poll(SourceSink &sink, int timeoutMs)
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0)
+        return -1;
+
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int rv = ::poll(&pfd, 1, timeoutMs);
+    if (rv <= 0)
+        return (rv < 0 && errno != EINTR) ? -1 : 0;
+
+    qint64 total = 0;
+    for (int i = 0; i < MAX_BATCHES_PER_POLL; i++) {
+        int received = receiveBatch(sink, total);
+        if (received < 0)
+            return total > 0 ? total : -1;
+        if (received < BATCH_SIZE)
+            break;  // Socket drained
+    }
+    return total;
+#else
+    Q_UNUSED(sink);
+    Q_UNUSED(timeoutMs);
+    return -1;
+#endif
+}
+
+int UdpSource::receiveBatch(SourceSink &sink, qint64 &bytes)
+{
+#ifdef Q_OS_LINUX
+    // msg_controllen and msg_flags are in/out, so they are reset for every call
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        struct msghdr &hdr = m_batch->msgs[i].msg_hdr;
+        hdr.msg_name = nullptr;
+        hdr.msg_namelen = 0;
+        hdr.msg_iov = &m_batch->iov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = m_batch->control[i];
+        hdr.msg_controllen = sizeof(m_batch->control[i]);
+        hdr.msg_flags = 0;
+    }
+
+    int count = ::recvmmsg(m_fd, m_batch->msgs, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (count < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    // Kernel stamps are CLOCK_REALTIME; shift them onto the monotonic host timeline
+    struct timespec realNow, monoNow;
+    clock_gettime(CLOCK_REALTIME, &realNow);
+    clock_gettime(CLOCK_MONOTONIC, &monoNow);
+    const qint64 monoNowNs = timespecToNs(monoNow);
+    const qint64 realToMono = monoNowNs - timespecToNs(realNow);
+
+    for (int i = 0; i < count; i++) {
+        struct msghdr &hdr = m_batch->msgs[i].msg_hdr;
+        qint64 timestampNs = monoNowNs;
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                timestampNs = timespecToNs(ts) + realToMono;
+                break;
+            }
+        }
+
+        if (hdr.msg_flags & MSG_TRUNC)
+            m_truncatedDatagrams++;
+
+        sink.chunkReceived(m_batch->buffers[i], m_batch->msgs[i].msg_len, timestampNs);
+        bytes += m_batch->msgs[i].msg_len;
+    }
+
+    m_datagramsReceived += count;
+    return count;
+#else
+    Q_UNUSED(sink);
+    Q_UNUSED(bytes);
+    return -1;
+#endif
+}
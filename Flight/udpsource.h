@@ -0,0 +1,50 @@
+#ifndef UDPSOURCE_H
+#define UDPSOURCE_H
+
+#include <QString>
+#include "telemetrysource.h"
+
+#define UDP_TELEMETRY_PORT  14550
+
+/**
+ * @brief UDP telemetry source for companion-computer forwarding
+ *
+ * Receives in batches with recvmmsg() into buffers allocated once in open(), and
+ * stamps every datagram with its kernel receive time (SO_TIMESTAMPNS) converted
+ * onto the host monotonic timeline. Each datagram is delivered as one chunk.
+ * Linux only; open() fails elsewhere.
+ */
+class UdpSource : public TelemetrySource
+{
+public:
+    static const int BATCH_SIZE = 64;           // Datagrams per recvmmsg() call
+    static const int MAX_DATAGRAM_SIZE = 2048;
+    static const int MAX_BATCHES_PER_POLL = 16; // Bound the time spent draining per poll
+
+    explicit UdpSource(quint16 port = UDP_TELEMETRY_PORT, const QString &bindAddress = QString());
+    ~UdpSource() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_fd >= 0; }
+    qint64 poll(SourceSink &sink, int timeoutMs) override;
+    int handle() const override { return m_fd; }
+
+    quint64 datagramsReceived() const { return m_datagramsReceived; }
+    quint64 truncatedDatagrams() const { return m_truncatedDatagrams; }
+
+private:
+    struct Batch;
+
+    int receiveBatch(SourceSink &sink, qint64 &bytes);
+
+    quint16 m_port;
+    QString m_bindAddress;
+    int m_fd;
+    Batch *m_batch;
+
+    quint64 m_datagramsReceived;
+    quint64 m_truncatedDatagrams;
+};
+
+#endif // UDPSOURCE_H
@@ -0,0 +1,136 @@
+#include "vehicle.h"
+#include <QDebug>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QtCharts/QXYSeries>
+#include "linkreader.h"
+#include "serialsource.h"
+#include "udpsource.h"
+
+QT_USE_NAMESPACE
+
+Vehicle::Vehicle(QObject *parent) :
+    QObject(parent),
+    m_reorder(qint64(DEFAULT_MAX_LATENCY_MS) * 1000000),
+    m_mergeTimer(new QTimer(this)),
+    m_startNs(0)
+{
+    m_scratch.resize(LinkReader::RING_SIZE);
+    m_mergeTimer->setInterval(MERGE_INTERVAL_MS);
+    connect(m_mergeTimer, &QTimer::timeout, this, &Vehicle::mergeSamples);
+}
+
+Vehicle::~Vehicle()
+{
+    stop();
+    for (const Link &link : m_links) {
+        delete link.reader;
+        delete link.thread;
+    }
+}
+
+TelemetrySource *Vehicle::createSource(const QString &spec)
+{
+    const QStringList parts = spec.split(QLatin1Char(':'));
+    const QString kind = parts.value(0).toLower();
+
+    if (kind == QLatin1String("serial") && parts.size() >= 2) {
+        bool ok = true;
+        const qint32 baud = parts.size() >= 3 ? parts.at(2).toInt(&ok) : qint32(QSerialPort::Baud115200);
+        if (ok)
+            return new SerialSource(parts.at(1), baud);
+    } else if (kind == QLatin1String("udp") && parts.size() >= 2) {
+        bool ok = false;
+        const quint16 port = parts.at(1).toUShort(&ok);
+        if (ok)
+            return new UdpSource(port, parts.value(2));
+    }
+
+    qWarning() << "Vehicle: Invalid link spec" << spec;
+    return nullptr;
+}
+
+bool Vehicle::addLink(const QString &spec)
+{
+    if (m_links.size() >= 255) {
+        qWarning() << "Vehicle: Too many links";
+        return false;
+    }
+
+    TelemetrySource *source = createSource(spec);
+    if (!source)
+        return false;
+
+    Link link;
+    link.thread = new QThread();
+    link.reader = new LinkReader(quint8(m_links.size()), source);
+    link.reader->moveToThread(link.thread);
+
+    QThread *thread = link.thread;
+    connect(link.reader, &LinkReader::workRequested, thread, [thread]() {
+        thread->start();
+    });
+    connect(link.thread, &QThread::started, link.reader, &LinkReader::doWork);
+    connect(link.reader, &LinkReader::finished, link.thread, &QThread::quit, Qt::DirectConnection);
+
+    m_links.append(link);
+    qDebug() << "Vehicle: Link" << m_links.size() - 1 << "is" << spec;
+    return true;
+}
+
+void Vehicle::setMaxLatencyMs(int ms)
+{
+    m_reorder.setMaxLatencyNs(qint64(ms) * 1000000);
+}
+
+void Vehicle::start()
+{
+    m_startNs = HostClock::nowNs();
+    m_history.clear();
+    for (const Link &link : m_links)
+        link.reader->requestWork();
+    m_mergeTimer->start();
+}
+
+void Vehicle::stop()
+{
+    m_mergeTimer->stop();
+    for (const Link &link : m_links) {
+        link.reader->abort();
+        if (link.thread->isRunning()) {
+            link.thread->quit();
+            link.thread->wait();
+        }
+    }
+}
+
+void Vehicle::mergeSamples()
+{
+    auto emitPoint = [this](const TelemetrySample &sample) { appendPoint(sample); };
+
+    for (const Link &link : m_links) {
+        const size_t count = link.reader->samples()->pop_batch(m_scratch.data(), m_scratch.size());
+        for (size_t i = 0; i < count; i++)
+            m_reorder.insert(m_scratch[i], emitPoint);
+    }
+
+    if (m_reorder.release(HostClock::nowNs(), emitPoint) > 0)
+        emit updateCurve();
+}
+
+void Vehicle::appendPoint(const TelemetrySample &sample)
+{
+    QList<QPointF> &history = m_history[channelKey(sample.link, sample.channel)];
+    if (history.size() >= HISTORY_POINTS)
+        history.removeFirst();
+    history.append(QPointF(qreal(sample.timestampNs - m_startNs) / 1e9, qreal(sample.value)));
+}
+
+void Vehicle::update(QAbstractSeries *series, int link, int channel)
+{
+    if (series) {
+        QXYSeries *xySeries = static_cast<QXYSeries *>(series);
+        xySeries->replace(m_history.value(channelKey(link, channel)));
+    }
+}
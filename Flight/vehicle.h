@@ -0,0 +1,77 @@
+#ifndef VEHICLE_H
+#define VEHICLE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include <vector>
+#include "reorderbuffer.h"
+#include "telemetrysource.h"
+
+QT_BEGIN_NAMESPACE
+class QAbstractSeries;
+class QThread;
+class QTimer;
+QT_END_NAMESPACE
+
+class LinkReader;
+
+/**
+ * @brief One vehicle fed by N concurrent links
+ *
+ * Each link runs a LinkReader on its own thread. On the GUI thread the vehicle
+ * drains the per-link rings through a bounded-latency ReorderBuffer, so channels
+ * of every link share one host-time axis (seconds since start()).
+ *
+ * Link specs: "serial:<port>[:<baud>]" or "udp:<port>[:<bind address>]".
+ */
+class Vehicle : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int linkCount READ linkCount CONSTANT)
+public:
+    static const int HISTORY_POINTS = 2100;     // Per channel, as SamplerWorker keeps
+    static const int MERGE_INTERVAL_MS = 20;
+    static const int DEFAULT_MAX_LATENCY_MS = 50;
+
+    explicit Vehicle(QObject *parent = nullptr);
+    ~Vehicle();
+
+    static TelemetrySource *createSource(const QString &spec);
+
+    bool addLink(const QString &spec);
+    int linkCount() const { return m_links.size(); }
+
+    void start();
+    void stop();
+    void setMaxLatencyMs(int ms);
+
+    Q_INVOKABLE void update(QAbstractSeries *series, int link, int channel);
+    Q_INVOKABLE int lateSamples() const { return int(m_reorder.lateSamples()); }
+
+signals:
+    void updateCurve();
+
+private slots:
+    void mergeSamples();
+
+private:
+    struct Link {
+        LinkReader *reader;
+        QThread *thread;
+    };
+
+    static quint32 channelKey(int link, int channel) { return (quint32(link) << 16) | quint32(channel & 0xFFFF); }
+    void appendPoint(const TelemetrySample &sample);
+
+    QVector<Link> m_links;
+    ReorderBuffer m_reorder;
+    QTimer *m_mergeTimer;
+    qint64 m_startNs;
+    std::vector<TelemetrySample> m_scratch;
+    QHash<quint32, QList<QPointF>> m_history;
+};
+
+#endif // VEHICLE_H